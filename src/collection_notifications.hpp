@@ -22,10 +22,14 @@
 #include "index_set.hpp"
 #include "util/atomic_shared_ptr.hpp"
 
+#include <realm/keys.hpp>
+
+#include <chrono>
 #include <exception>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace realm {
@@ -96,6 +100,15 @@ struct CollectionChangeSet {
     }
 };
 
+// A list of key paths which a notification callback is interested in. Each key
+// path is the sequence of tables and columns followed from the collection's
+// object type, with every column other than the last being a link. For
+// example, `name` and `avatar.url` on a `Person` would be
+// `{{{person, name}}, {{person, avatar}, {image, url}}}`. Modifications to
+// columns which aren't in any of the key paths are not reported, while
+// insertions and deletions are always reported.
+using KeyPathArray = std::vector<std::vector<std::pair<TableKey, ColKey>>>;
+
 // A type-erasing wrapper for the callback for collection notifications. Can be
 // constructed with either any callable compatible with the signature
 // `void (CollectionChangeSet, std::exception_ptr)`, an object with member
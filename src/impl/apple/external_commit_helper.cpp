@@ -228,7 +228,7 @@ void ExternalCommitHelper::listen()
         }
         assert(event.ident == (uint32_t)m_notify_fd);
 
-        m_parent.on_change();
+        m_parent.on_external_change();
     }
 }
 
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/change_info_cache.hpp"
+
+#include "impl/notifier_statistics.hpp"
+#include "impl/transact_log_handler.hpp"
+
+#include <realm/db.hpp>
+
+using namespace realm;
+using namespace realm::_impl;
+
+void ChangeInfoCache::Entry::copy_to(TransactionChangeInfo& info) const
+{
+    if (schema_changed)
+        info.schema_changed = true;
+
+    if (info.track_all) {
+        for (auto& table : tables)
+            info.tables[table.first].merge(table.second);
+    }
+    else {
+        for (auto& table : info.tables) {
+            auto it = tables.find(table.first);
+            if (it != tables.end())
+                table.second.merge(it->second);
+        }
+    }
+
+    for (auto it = info.tables.begin(); it != info.tables.end(); ) {
+        if (it->second.empty())
+            it = info.tables.erase(it);
+        else
+            ++it;
+    }
+}
+
+ChangeInfoCache::ChangeInfoCache(NotifierStatistics& statistics, size_t capacity, size_t max_bytes)
+: m_statistics(statistics)
+, m_capacity(capacity)
+, m_max_bytes(max_bytes)
+{
+    REALM_ASSERT(capacity > 0);
+}
+
+void ChangeInfoCache::advance(Transaction& tr, TransactionChangeInfo& info, VersionID version)
+{
+    // If no changes are needed then the log doesn't need to be parsed at all,
+    // and list changes can only be gathered by parsing it
+    if ((!info.track_all && info.tables.empty()) || !info.lists.empty()) {
+        transaction::advance(tr, info, version);
+        return;
+    }
+
+    auto from = tr.get_version_of_current_transaction().version;
+    auto to = version == VersionID{} ? tr.get_version_of_latest_snapshot() : version.version;
+    if (from == to) {
+        transaction::advance(tr, info, version);
+        return;
+    }
+
+    if (auto entry = find(from, to)) {
+        tr.advance_read(entry->to);
+        entry->copy_to(info);
+        return;
+    }
+
+    // Parsing every table only pays off if something else will reuse it
+    if (!is_shared()) {
+        transaction::advance(tr, info, version);
+        return;
+    }
+
+    // Gather the changes for every table so that the entry can be used by
+    // Transactions which need different tables from this one
+    auto entry = std::make_shared<Entry>();
+    {
+        // The entry outlives the notifier run which may have an arena active
+        ChunkArena::Scope heap_scope(nullptr);
+        TransactionChangeInfo all{{}, {}, true, false};
+        transaction::advance(tr, all, version);
+
+        entry->from = from;
+        entry->to = tr.get_version_of_current_transaction();
+        entry->tables = std::move(all.tables);
+        entry->schema_changed = all.schema_changed;
+        entry->size = 0;
+        for (auto& table : entry->tables)
+            entry->size += table.second.memory_usage();
+    }
+    entry->copy_to(info);
+    add(std::move(entry));
+}
+
+std::shared_ptr<const ChangeInfoCache::Entry> ChangeInfoCache::find(VersionID::version_type from,
+                                                                    VersionID::version_type to) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        if ((*it)->from == from && (*it)->to.version == to) {
+            m_statistics.change_info_cache_hits.fetch_add(1, std::memory_order_relaxed);
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+void ChangeInfoCache::add(std::shared_ptr<const Entry> entry)
+{
+    m_statistics.change_info_cache_misses.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Another thread may have parsed the same range at the same time
+    for (auto& existing : m_entries) {
+        if (existing->from == entry->from && existing->to == entry->to)
+            return;
+    }
+    // Very large changes, such as from a bulk import, aren't worth keeping
+    // around on the off chance that something else advances over them
+    if (entry->size > m_max_bytes)
+        return;
+    while (!m_entries.empty() && (m_entries.size() == m_capacity || m_size + entry->size > m_max_bytes)) {
+        m_size -= m_entries.front()->size;
+        m_entries.pop_front();
+    }
+    m_size += entry->size;
+    m_entries.push_back(std::move(entry));
+}
+
+void ChangeInfoCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_size = 0;
+    m_has_observers = false;
+}
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_CHANGE_INFO_CACHE_HPP
+#define REALM_CHANGE_INFO_CACHE_HPP
+
+#include "impl/collection_notifier.hpp"
+
+#include <realm/version_id.hpp>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace realm {
+class Transaction;
+
+namespace _impl {
+struct NotifierStatistics;
+
+// The table-level changes made by each recently-parsed range of versions of
+// a Realm file. When more than one Transaction is advanced over each range
+// (several notifier worker groups, or Realms with KVO observers which refresh
+// over the same versions as the notifiers), each would otherwise decode the
+// same transaction logs again, so the first advance over a range parses the
+// logs for all tables and later ones copy the changes they need out of the
+// cache. When there's only one consumer, advances just parse the tables they
+// need and nothing is cached.
+//
+// List changes are not cached, as they are only gathered for the specific
+// lists which were requested and a later advance may need different ones.
+class ChangeInfoCache {
+public:
+    struct Entry {
+        VersionID::version_type from;
+        VersionID to;
+        std::unordered_map<TableKeyType, ObjectChangeSet> tables;
+        bool schema_changed;
+        // The approximate heap memory used by `tables`
+        size_t size;
+
+        // Merge the changes for the tables in `info` (or all tables if
+        // info.track_all is set) into `info`, removing the tables which had
+        // no changes as parsing the transaction log would have
+        void copy_to(TransactionChangeInfo& info) const;
+    };
+
+    // At most `capacity` entries are kept, and entries are evicted oldest
+    // first to keep their total size under `max_bytes`
+    ChangeInfoCache(NotifierStatistics& statistics, size_t capacity = 8, size_t max_bytes = 16 * 1024 * 1024);
+
+    ChangeInfoCache(ChangeInfoCache const&) = delete;
+    ChangeInfoCache& operator=(ChangeInfoCache const&) = delete;
+
+    // Advance `tr` to `version`, or the latest version if `version` is
+    // VersionID{}, gathering change information in `info`. Equivalent to
+    // transaction::advance(), but uses the cached changes if another
+    // Transaction has already been advanced over the same range.
+    void advance(Transaction& tr, TransactionChangeInfo& info, VersionID version=VersionID{});
+
+    // The number of notifier worker groups whose Transactions are advanced
+    // over the same versions in each run. Set by the coordinator.
+    void set_worker_group_count(size_t count) noexcept { m_worker_group_count = count; }
+    // Record that a Realm with KVO observers has refreshed, and so will want
+    // the changes for the versions the notifiers advance over
+    void set_has_observers() noexcept { m_has_observers = true; }
+
+    // Get the cached changes between the versions numbered `from` and `to`,
+    // or null if they have not been parsed recently
+    std::shared_ptr<const Entry> find(VersionID::version_type from, VersionID::version_type to) const;
+
+    // Discard all cached changes. Must be called if the version numbers of
+    // the file may be reused, such as when the DB is closed.
+    void clear();
+
+private:
+    NotifierStatistics& m_statistics;
+    const size_t m_capacity;
+    const size_t m_max_bytes;
+    std::atomic<size_t> m_worker_group_count{1};
+    std::atomic<bool> m_has_observers{false};
+
+    mutable std::mutex m_mutex;
+    // Oldest first. This only holds a handful of entries, so a linear search
+    // is cheaper than maintaining an index.
+    std::deque<std::shared_ptr<const Entry>> m_entries;
+    size_t m_size = 0;
+
+    // Whether anything other than the Transaction doing the parsing is
+    // likely to want the changes for the same range of versions
+    bool is_shared() const noexcept { return m_worker_group_count > 1 || m_has_observers; }
+    void add(std::shared_ptr<const Entry> entry);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_CHANGE_INFO_CACHE_HPP
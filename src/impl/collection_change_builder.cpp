@@ -18,6 +18,9 @@
 
 #include "impl/collection_change_builder.hpp"
 
+#include "impl/collection_notifier.hpp"
+#include "impl/notifier_worker_pool.hpp"
+
 #include <realm/util/assert.hpp>
 
 #include <algorithm>
@@ -49,21 +52,40 @@ void CollectionChangeBuilder::merge(CollectionChangeBuilder&& c)
     verify();
     c.verify();
 
-    // FIXME: this is comically wasteful
-    std::unordered_set<int64_t> col_keys;
+    // Pair up the IndexSets for each column in the two changesets once up
+    // front so that the operations below don't have to look them up by key.
+    // Elements of an unordered_map are never moved by inserting into it, so
+    // the pointers remain valid. Columns which were only modified in this
+    // changeset are paired with a scratch IndexSet rather than adding an entry
+    // to `c` which would just be thrown away. With the lookups hoisted out of
+    // the loops, merging is dominated by shifting each column's IndexSet for
+    // the new insertions and deletions, which a denser container for
+    // `columns` would still have to do.
+    std::vector<std::pair<IndexSet*, IndexSet*>> col_pairs;
+    std::vector<IndexSet> unmodified_cols;
     if (m_track_columns) {
-        for (auto& col : columns)
-            col_keys.insert(col.first);
-        for (auto& col : c.columns)
-            col_keys.insert(col.first);
+        col_pairs.reserve(columns.size() + c.columns.size());
+        unmodified_cols.reserve(columns.size());
+        for (auto& col : columns) {
+            auto it = c.columns.find(col.first);
+            if (it != c.columns.end()) {
+                col_pairs.push_back({&col.second, &it->second});
+            }
+            else {
+                unmodified_cols.emplace_back();
+                col_pairs.push_back({&col.second, &unmodified_cols.back()});
+            }
+        }
+        for (auto& col : c.columns) {
+            if (!columns.count(col.first))
+                col_pairs.push_back({&columns[col.first], &col.second});
+        }
     }
 
     auto for_each_col = [&](auto&& f) {
         f(modifications, c.modifications);
-        if (m_track_columns) {
-            for (auto col : col_keys)
-                f(columns[col], c.columns[col]);
-        }
+        for (auto& col : col_pairs)
+            f(*col.first, *col.second);
     };
 
     // First update any old moves
@@ -175,6 +197,16 @@ void CollectionChangeBuilder::for_each_col(Func&& f)
     }
 }
 
+void CollectionChangeBuilder::detach_from_arena()
+{
+    deletions.detach_from_arena();
+    insertions.detach_from_arena();
+    modifications.detach_from_arena();
+    modifications_new.detach_from_arena();
+    for (auto& col : columns)
+        col.second.detach_from_arena();
+}
+
 void CollectionChangeBuilder::insert(size_t index, size_t count, bool track_moves)
 {
     REALM_ASSERT(count != 0);
@@ -364,9 +396,11 @@ public:
 
     LongestCommonSubsequenceCalculator(std::vector<Row>& a, std::vector<Row>& b,
                                        size_t start_index,
-                                       IndexSet const& modifications)
+                                       IndexSet const& modifications,
+                                       size_t max_cost)
     : m_modified(modifications)
     , a(a), b(b)
+    , m_remaining_cost(max_cost)
     {
         find_longest_matches(start_index, a.size(),
                              start_index, b.size());
@@ -380,6 +414,20 @@ private:
     // a is sorted by tv_index, b is sorted by key
     std::vector<Row> &a, &b;
 
+    // The number of pairs of rows which can still be compared before giving
+    // up on finding more matches
+    size_t m_remaining_cost;
+
+    struct Length {
+        size_t j, len;
+    };
+    // The length of the matching block for each `j` for the previously checked
+    // row and for the row currently being checked. Both are sorted by `j`.
+    // Stored here rather than in find_longest_match() so that the allocations
+    // are reused.
+    std::vector<Length> m_prev;
+    std::vector<Length> m_cur;
+
     // Find the longest matching range in (a + begin1, a + end1) and (b + begin2, b + end2)
     // "Matching" is defined as "has the same row index"; the TV index is just
     // there to let us turn an index in a/b into an index which can be reported
@@ -389,23 +437,25 @@ private:
     // algorithm for longest common subsequence, where N is the maximum number
     // of the most common row index (which for everything but linkview-derived
     // TVs will be 1).
+    //
+    // If the cost limit is reached partway through, the longest match found
+    // so far is returned.
     Match find_longest_match(size_t begin1, size_t end1, size_t begin2, size_t end2)
     {
-        struct Length {
-            size_t j, len;
-        };
-        // The length of the matching block for each `j` for the previously checked row
-        std::vector<Length> prev;
-        // The length of the matching block for each `j` for the row currently being checked
-        std::vector<Length> cur;
+        auto& prev = m_prev;
+        auto& cur = m_cur;
+        prev.clear();
+        cur.clear();
 
         // Calculate the length of the matching block *ending* at b[j], which
         // is 1 if b[j - 1] did not match, and b[j - 1] + 1 otherwise.
         auto length = [&](size_t j) -> size_t {
-            for (auto const& pair : prev) {
-                if (pair.j + 1 == j)
-                    return pair.len + 1;
-            }
+            if (j == 0)
+                return 1;
+            auto it = std::lower_bound(prev.begin(), prev.end(), j - 1,
+                                       [](auto const& lft, size_t rgt) { return lft.j < rgt; });
+            if (it != prev.end() && it->j + 1 == j)
+                return it->len + 1;
             return 1;
         };
 
@@ -430,7 +480,7 @@ private:
         };
 
         Match best = {begin1, begin2, 0, 0};
-        for (size_t i = begin1; i < end1; ++i) {
+        for (size_t i = begin1; i < end1 && m_remaining_cost > 0; ++i) {
             // prev = std::move(cur), but avoids discarding prev's heap allocation
             cur.swap(prev);
             cur.clear();
@@ -457,29 +507,44 @@ private:
                 REALM_ASSERT(best.i >= begin1 && best.i + best.size <= end1);
                 REALM_ASSERT(best.j >= begin2 && best.j + best.size <= end2);
             });
+            m_remaining_cost -= std::min(m_remaining_cost, cur.size() + 1);
         }
         return best;
     }
 
     void find_longest_matches(size_t begin1, size_t end1, size_t begin2, size_t end2)
     {
-        // FIXME: recursion could get too deep here
-        // recursion depth worst case is currently O(N) and each recursion uses 320 bytes of stack
-        // could reduce worst case to O(sqrt(N)) (and typical case to O(log N))
-        // biasing equal selections towards the middle, but that's still
-        // insufficient for Android's 8 KB stacks
-        auto m = find_longest_match(begin1, end1, begin2, end2);
-        if (!m.size)
-            return;
-        if (m.i > begin1 && m.j > begin2)
-            find_longest_matches(begin1, m.i, begin2, m.j);
-        m_longest_matches.push_back(m);
-        if (m.i + m.size < end2 && m.j + m.size < end2)
-            find_longest_matches(m.i + m.size, end1, m.j + m.size, end2);
+        // Each range is split into the parts before and after its longest
+        // match, which are then searched in turn. This is done with an explicit
+        // stack rather than recursion as the depth is O(N) in the worst case.
+        struct Range {
+            size_t begin1, end1, begin2, end2;
+        };
+        std::vector<Range> ranges;
+        ranges.push_back({begin1, end1, begin2, end2});
+        while (!ranges.empty() && m_remaining_cost > 0) {
+            auto r = ranges.back();
+            ranges.pop_back();
+
+            auto m = find_longest_match(r.begin1, r.end1, r.begin2, r.end2);
+            if (!m.size)
+                continue;
+            m_longest_matches.push_back(m);
+            if (m.i + m.size < r.end1 && m.j + m.size < r.end2)
+                ranges.push_back({m.i + m.size, r.end1, m.j + m.size, r.end2});
+            if (m.i > r.begin1 && m.j > r.begin2)
+                ranges.push_back({r.begin1, m.i, r.begin2, m.j});
+        }
+
+        // Anything not covered by a match once the cost limit has been hit
+        // is reported as deleted and reinserted. The matches are strictly
+        // increasing in both i and j, so sorting by either puts them in order.
+        std::sort(m_longest_matches.begin(), m_longest_matches.end(),
+                  [](auto const& lft, auto const& rgt) { return lft.i < rgt.i; });
     }
 };
 
-void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& changeset)
+void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& changeset, size_t max_cost)
 {
     // The RowInfo array contains information about the old and new TV indices of
     // each row, which we need to turn into two sequences of rows, which we'll
@@ -515,7 +580,7 @@ void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& cha
 
     // Calculate the LCS of the two sequences
     auto matches = LongestCommonSubsequenceCalculator(a, b, first_difference,
-                                                      changeset.modifications).m_longest_matches;
+                                                      changeset.modifications, max_cost).m_longest_matches;
 
     // And then insert and delete rows as needed to align them
     size_t i = first_difference, j = first_difference;
@@ -556,9 +621,95 @@ void verify_changeset(std::vector<T> const& prev_rows,
 #endif
 }
 
+template<typename T>
+bool is_sorted_and_unique(std::vector<T> const& rows)
+{
+    return std::adjacent_find(begin(rows), end(rows), [](T lft, T rgt) {
+        return static_cast<int64_t>(lft) >= static_cast<int64_t>(rgt);
+    }) == end(rows);
+}
+
+// Calculate the changes between two collections which are each already sorted
+// by key. A row's index in the collection is then also its position in the
+// key-sorted order, so there is no need to build RowInfo, no moves are
+// possible, and each run of matching, deleted or inserted rows is contiguous
+// in both the keys and the collection indices. This lets us skip over runs of
+// unchanged rows with std::mismatch() and find the end of each run of
+// deletions or insertions with a binary search, and report each run to the
+// change builder as a single range rather than one index at a time.
+//
+// Call `fn(i)` for the offset from `first` of each key in [first, last) which
+// was modified, in ascending order
+template<typename Checker, typename Iterator, typename Fn>
+void for_each_modified(Checker& key_did_change, Iterator first, Iterator last, Fn&& fn)
+{
+    for (auto it = first; it != last; ++it) {
+        if (key_did_change(*it))
+            fn(it - first);
+    }
+}
+
+// Runs of sorted keys can be checked against a single table's modifications
+// in bulk rather than looking up each key
+template<typename Iterator, typename Fn>
+void for_each_modified(TableChangeChecker& key_did_change, Iterator first, Iterator last, Fn&& fn)
+{
+    key_did_change.for_each_modified(first, last, fn);
+}
+
+// Only the rows in [old_first, old_last) and [new_first, new_last) are
+// compared, which lets the work be split up by key range.
+template<typename Checker>
+void calculate_presorted(CollectionChangeBuilder& ret,
+                         std::vector<int64_t> const& old_rows, size_t old_first, size_t old_last,
+                         std::vector<int64_t> const& new_rows, size_t new_first, size_t new_last,
+                         Checker& key_did_change)
+{
+    auto old_begin = old_rows.begin(), old_end = old_begin + old_last;
+    auto new_begin = new_rows.begin(), new_end = new_begin + new_last;
+    auto old_it = old_begin + old_first, new_it = new_begin + new_first;
+
+    while (old_it != old_end && new_it != new_end) {
+        auto match_end = std::mismatch(old_it, old_end, new_it, new_end);
+        size_t offset = new_it - new_begin;
+        size_t modified_begin = IndexSet::npos, modified_end = IndexSet::npos;
+        for_each_modified(key_did_change, new_it, match_end.second, [&](size_t i) {
+            if (i + offset != modified_end) {
+                if (modified_begin != IndexSet::npos)
+                    ret.modifications.add(modified_begin, modified_end);
+                modified_begin = i + offset;
+            }
+            modified_end = i + offset + 1;
+        });
+        if (modified_begin != IndexSet::npos)
+            ret.modifications.add(modified_begin, modified_end);
+        new_it = match_end.second;
+
+        old_it = match_end.first;
+        if (old_it == old_end || new_it == new_end)
+            break;
+
+        if (*old_it < *new_it) {
+            auto run_end = std::lower_bound(old_it, old_end, *new_it);
+            ret.deletions.add(old_it - old_begin, run_end - old_begin);
+            old_it = run_end;
+        }
+        else {
+            auto run_end = std::lower_bound(new_it, new_end, *old_it);
+            ret.insertions.add(new_it - new_begin, run_end - new_begin);
+            new_it = run_end;
+        }
+    }
+
+    ret.deletions.add(old_it - old_begin, old_last);
+    ret.insertions.add(new_it - new_begin, new_last);
+}
+
+template<typename Checker>
 void calculate(CollectionChangeBuilder& ret,
                std::vector<RowInfo> old_rows, std::vector<RowInfo> new_rows,
-               std::function<bool (int64_t)> key_did_change, bool in_table_order)
+               Checker& key_did_change, bool in_table_order,
+               size_t max_move_calculation_cost)
 {
     // Now that our old and new sets of rows are sorted by key, we can
     // iterate over them and either record old+new TV indices for rows present
@@ -602,28 +753,251 @@ void calculate(CollectionChangeBuilder& ret,
     }
 
     if (!in_table_order)
-        calculate_moves_sorted(new_rows, ret);
+        calculate_moves_sorted(new_rows, ret, max_move_calculation_cost);
+}
+
+// Pick the keys which split `keys` into `count` ranges of roughly equal size,
+// with range i holding the keys in [splitters[i - 1], splitters[i]). Unsorted
+// keys are sampled rather than sorting all of them.
+std::vector<int64_t> choose_splitters(std::vector<int64_t> const& keys, size_t count, bool sorted)
+{
+    std::vector<int64_t> sample;
+    if (!sorted) {
+        size_t stride = std::max<size_t>(keys.size() / (count * 64), 1);
+        for (size_t i = 0; i < keys.size(); i += stride)
+            sample.push_back(keys[i]);
+        std::sort(begin(sample), end(sample));
+    }
+
+    auto& source = sorted ? keys : sample;
+    std::vector<int64_t> splitters;
+    splitters.reserve(count - 1);
+    for (size_t i = 1; i < count; ++i)
+        splitters.push_back(source[source.size() * i / count]);
+    return splitters;
+}
+
+// Add each run of set flags in `flags` to `indexes` as a single range
+void add_flagged(IndexSet& indexes, std::vector<char> const& flags)
+{
+    auto it = flags.begin(), end = flags.end();
+    while (it != end) {
+        auto run_begin = std::find(it, end, 1);
+        it = std::find(run_begin, end, 0);
+        indexes.add(run_begin - flags.begin(), it - flags.begin());
+    }
+}
+
+// calculate_presorted() over each range of keys in parallel. Every index in a
+// range's changes comes after every index in the previous range's changes, so
+// the results for each range can simply be appended to each other.
+void calculate_presorted_in_parallel(CollectionChangeBuilder& ret,
+                                     std::vector<int64_t> const& old_rows, std::vector<int64_t> const& new_rows,
+                                     std::function<bool (int64_t)> const& key_did_change,
+                                     NotifierWorkerPool& pool)
+{
+    size_t count = pool.thread_count();
+    auto splitters = choose_splitters(old_rows.size() > new_rows.size() ? old_rows : new_rows, count, true);
+    auto split = [&](std::vector<int64_t> const& rows, size_t i) -> size_t {
+        if (i == 0)
+            return 0;
+        if (i == count)
+            return rows.size();
+        return std::lower_bound(rows.begin(), rows.end(), splitters[i - 1]) - rows.begin();
+    };
+
+    std::vector<std::function<bool (int64_t)>> checkers(count, key_did_change);
+    // The partial changes are filled in on different threads, so they can't
+    // share the caller's ChunkArena
+    ChunkArena::Scope heap_scope(nullptr);
+    std::vector<CollectionChangeBuilder> changes(count);
+    pool.run(count, [&](size_t i) {
+        calculate_presorted(changes[i], old_rows, split(old_rows, i), split(old_rows, i + 1),
+                            new_rows, split(new_rows, i), split(new_rows, i + 1), checkers[i]);
+    });
+
+    auto append = [](IndexSet& indexes, IndexSet const& later_indexes) {
+        for (auto range : later_indexes)
+            indexes.add(range.first, range.second);
+    };
+    for (auto& change : changes) {
+        append(ret.deletions, change.deletions);
+        append(ret.insertions, change.insertions);
+        append(ret.modifications, change.modifications);
+    }
+}
+
+// The equivalent of calculate() for unsorted rows. The rows are scattered into
+// ranges of keys which are then each sorted and merged in parallel. Rather
+// than producing IndexSets which would have to be merged afterwards, each
+// range flags the rows it finds to be deleted, inserted or modified; the
+// ranges write to disjoint elements of the flag arrays so this needs no
+// synchronization, and the flags are then turned into IndexSets in one pass.
+void calculate_in_parallel(CollectionChangeBuilder& ret,
+                           std::vector<int64_t> const& old_rows, std::vector<int64_t> const& new_rows,
+                           std::function<bool (int64_t)> const& key_did_change, bool in_table_order,
+                           NotifierWorkerPool& pool, size_t max_move_calculation_cost)
+{
+    size_t count = pool.thread_count();
+    auto splitters = choose_splitters(old_rows.size() > new_rows.size() ? old_rows : new_rows, count, false);
+
+    auto scatter = [&](std::vector<int64_t> const& rows) {
+        std::vector<std::vector<RowInfo>> ranges(count);
+        for (auto& range : ranges)
+            range.reserve(rows.size() / count);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            size_t range = std::upper_bound(splitters.begin(), splitters.end(), rows[i]) - splitters.begin();
+            ranges[range].push_back({rows[i], IndexSet::npos, i});
+        }
+        return ranges;
+    };
+    auto old_ranges = scatter(old_rows);
+    auto new_ranges = scatter(new_rows);
+
+    std::vector<char> deleted(old_rows.size()), inserted(new_rows.size()), modified(new_rows.size());
+    // The rows present in both, indexed by their new position, for the move
+    // calculation
+    std::vector<RowInfo> matched(in_table_order ? 0 : new_rows.size(), RowInfo{0, IndexSet::npos, 0});
+
+    std::vector<std::function<bool (int64_t)>> checkers(count, key_did_change);
+    pool.run(count, [&](size_t i) {
+        auto& old_range = old_ranges[i];
+        auto& new_range = new_ranges[i];
+        auto by_key = [](auto& lft, auto& rgt) { return lft.key < rgt.key; };
+        std::sort(begin(old_range), end(old_range), by_key);
+        std::sort(begin(new_range), end(new_range), by_key);
+
+        size_t j = 0, k = 0;
+        while (j < old_range.size() && k < new_range.size()) {
+            auto& old_row = old_range[j];
+            auto& new_row = new_range[k];
+            if (old_row.key == new_row.key) {
+                if (checkers[i](new_row.key))
+                    modified[new_row.tv_index] = 1;
+                if (!in_table_order)
+                    matched[new_row.tv_index] = {new_row.key, old_row.tv_index, new_row.tv_index};
+                ++j;
+                ++k;
+            }
+            else if (old_row.key < new_row.key) {
+                deleted[old_row.tv_index] = 1;
+                ++j;
+            }
+            else {
+                inserted[new_row.tv_index] = 1;
+                ++k;
+            }
+        }
+        for (; j < old_range.size(); ++j)
+            deleted[old_range[j].tv_index] = 1;
+        for (; k < new_range.size(); ++k)
+            inserted[new_range[k].tv_index] = 1;
+    });
+
+    add_flagged(ret.deletions, deleted);
+    add_flagged(ret.insertions, inserted);
+    add_flagged(ret.modifications, modified);
+
+    if (!in_table_order) {
+        matched.erase(std::remove_if(begin(matched), end(matched),
+                                     [](auto& row) { return row.prev_tv_index == IndexSet::npos; }),
+                      end(matched));
+        calculate_moves_sorted(matched, ret, max_move_calculation_cost);
+    }
 }
 
 } // Anonymous namespace
 
-CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<int64_t> const& prev_rows,
-                                                           std::vector<int64_t> const& next_rows,
-                                                           std::function<bool (int64_t)> key_did_change,
-                                                           bool in_table_order)
+constexpr size_t CollectionChangeBuilder::default_max_move_calculation_cost;
+constexpr size_t CollectionChangeBuilder::default_parallel_calculation_threshold;
+
+template<typename Checker>
+CollectionChangeBuilder CollectionChangeBuilder::calculate_rows(std::vector<int64_t> const& prev_rows,
+                                                                std::vector<int64_t> const& next_rows,
+                                                                Checker& key_did_change,
+                                                                bool in_table_order,
+                                                                size_t max_move_calculation_cost)
 {
+    bool prev_sorted = is_sorted_and_unique(prev_rows);
+    bool next_sorted = is_sorted_and_unique(next_rows);
 
-    auto build_row_info = [](auto& rows) {
+    auto build_row_info = [](auto& rows, bool sorted) {
         std::vector<RowInfo> info;
         info.reserve(rows.size());
         for (size_t i = 0; i < rows.size(); ++i)
             info.push_back({rows[i], IndexSet::npos, i});
-        std::sort(begin(info), end(info), [](auto& lft, auto& rgt) { return lft.key < rgt.key; });
+        if (!sorted)
+            std::sort(begin(info), end(info), [](auto& lft, auto& rgt) { return lft.key < rgt.key; });
         return info;
     };
 
     CollectionChangeBuilder ret;
-    ::calculate(ret, build_row_info(prev_rows), build_row_info(next_rows), std::move(key_did_change), in_table_order);
+    // Results in table order are sorted by key, and there can't be any moves
+    // to find, so we can work directly on the keys
+    if (in_table_order && prev_sorted && next_sorted)
+        calculate_presorted(ret, prev_rows, 0, prev_rows.size(), next_rows, 0, next_rows.size(), key_did_change);
+    else
+        ::calculate(ret, build_row_info(prev_rows, prev_sorted), build_row_info(next_rows, next_sorted),
+                    key_did_change, in_table_order, max_move_calculation_cost);
+    ret.verify();
+    verify_changeset(prev_rows, next_rows, ret);
+    return ret;
+}
+
+CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<int64_t> const& prev_rows,
+                                                           std::vector<int64_t> const& next_rows,
+                                                           std::function<bool (int64_t)> key_did_change,
+                                                           bool in_table_order,
+                                                           size_t max_move_calculation_cost)
+{
+    return calculate_rows(prev_rows, next_rows, key_did_change, in_table_order, max_move_calculation_cost);
+}
+
+CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<int64_t> const& prev_rows,
+                                                           std::vector<int64_t> const& next_rows,
+                                                           NoChangesChecker key_did_change,
+                                                           bool in_table_order,
+                                                           size_t max_move_calculation_cost)
+{
+    return calculate_rows(prev_rows, next_rows, key_did_change, in_table_order, max_move_calculation_cost);
+}
+
+CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<int64_t> const& prev_rows,
+                                                           std::vector<int64_t> const& next_rows,
+                                                           TableChangeChecker& key_did_change,
+                                                           bool in_table_order,
+                                                           size_t max_move_calculation_cost)
+{
+    return calculate_rows(prev_rows, next_rows, key_did_change, in_table_order, max_move_calculation_cost);
+}
+
+CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<int64_t> const& prev_rows,
+                                                           std::vector<int64_t> const& next_rows,
+                                                           DeepChangeChecker& key_did_change,
+                                                           bool in_table_order,
+                                                           size_t max_move_calculation_cost)
+{
+    return calculate_rows(prev_rows, next_rows, key_did_change, in_table_order, max_move_calculation_cost);
+}
+
+CollectionChangeBuilder CollectionChangeBuilder::calculate_parallel(std::vector<int64_t> const& prev_rows,
+                                                                    std::vector<int64_t> const& next_rows,
+                                                                    std::function<bool (int64_t)> const& key_did_change,
+                                                                    bool in_table_order,
+                                                                    NotifierWorkerPool& pool,
+                                                                    size_t parallel_threshold,
+                                                                    size_t max_move_calculation_cost)
+{
+    size_t row_count = std::max(prev_rows.size(), next_rows.size());
+    if (pool.thread_count() < 2 || row_count < std::max(parallel_threshold, pool.thread_count()))
+        return calculate(prev_rows, next_rows, key_did_change, in_table_order, max_move_calculation_cost);
+
+    CollectionChangeBuilder ret;
+    if (in_table_order && is_sorted_and_unique(prev_rows) && is_sorted_and_unique(next_rows))
+        calculate_presorted_in_parallel(ret, prev_rows, next_rows, key_did_change, pool);
+    else
+        calculate_in_parallel(ret, prev_rows, next_rows, key_did_change, in_table_order, pool,
+                              max_move_calculation_cost);
     ret.verify();
     verify_changeset(prev_rows, next_rows, ret);
     return ret;
@@ -631,7 +1005,8 @@ CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<int64_t>
 
 CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<size_t> const& prev_rows,
                                                            std::vector<size_t> const& next_rows,
-                                                           std::function<bool (int64_t)> key_did_change)
+                                                           std::function<bool (int64_t)> key_did_change,
+                                                           size_t max_move_calculation_cost)
 {
 
     auto build_row_info = [](auto& rows) {
@@ -639,12 +1014,14 @@ CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<size_t> c
         info.reserve(rows.size());
         for (size_t i = 0; i < rows.size(); ++i)
             info.push_back({static_cast<int64_t>(rows[i]), IndexSet::npos, i});
-        std::sort(begin(info), end(info), [](auto& lft, auto& rgt) { return lft.key < rgt.key; });
+        if (!is_sorted_and_unique(rows))
+            std::sort(begin(info), end(info), [](auto& lft, auto& rgt) { return lft.key < rgt.key; });
         return info;
     };
 
     CollectionChangeBuilder ret;
-    ::calculate(ret, build_row_info(prev_rows), build_row_info(next_rows), std::move(key_did_change), false);
+    ::calculate(ret, build_row_info(prev_rows), build_row_info(next_rows), key_did_change, false,
+                max_move_calculation_cost);
     ret.verify();
     verify_changeset(prev_rows, next_rows, ret);
     return ret;
@@ -29,6 +29,10 @@
 
 namespace realm {
 namespace _impl {
+class DeepChangeChecker;
+class NotifierWorkerPool;
+class TableChangeChecker;
+struct NoChangesChecker;
 
 class CollectionChangeBuilder : public CollectionChangeSet {
 public:
@@ -42,15 +46,61 @@ public:
                             IndexSet modification = {},
                             std::vector<Move> moves = {});
 
+    // The default limit on the work done to find rows which moved in sorted
+    // collections, measured in the number of pairs of rows compared. Once
+    // it's reached, any rows which haven't yet been matched up are reported
+    // as deleted and then inserted rather than as moved.
+    static constexpr size_t default_max_move_calculation_cost = 10'000'000;
+
     // Calculate where rows need to be inserted or deleted from old_rows to turn
     // it into new_rows, and check all matching rows for modifications
     static CollectionChangeBuilder calculate(std::vector<int64_t> const& old_rows,
                                              std::vector<int64_t> const& new_rows,
                                              std::function<bool (int64_t)> key_did_change,
-                                             bool in_table_order);
+                                             bool in_table_order,
+                                             size_t max_move_calculation_cost=default_max_move_calculation_cost);
+    // Overloads of the above for the modification checkers which
+    // CollectionNotifier uses, which are called directly rather than through
+    // a std::function so that the per-row check can be inlined
+    static CollectionChangeBuilder calculate(std::vector<int64_t> const& old_rows,
+                                             std::vector<int64_t> const& new_rows,
+                                             NoChangesChecker key_did_change,
+                                             bool in_table_order,
+                                             size_t max_move_calculation_cost=default_max_move_calculation_cost);
+    static CollectionChangeBuilder calculate(std::vector<int64_t> const& old_rows,
+                                             std::vector<int64_t> const& new_rows,
+                                             TableChangeChecker& key_did_change,
+                                             bool in_table_order,
+                                             size_t max_move_calculation_cost=default_max_move_calculation_cost);
+    static CollectionChangeBuilder calculate(std::vector<int64_t> const& old_rows,
+                                             std::vector<int64_t> const& new_rows,
+                                             DeepChangeChecker& key_did_change,
+                                             bool in_table_order,
+                                             size_t max_move_calculation_cost=default_max_move_calculation_cost);
+
     static CollectionChangeBuilder calculate(std::vector<size_t> const& old_rows,
                                              std::vector<size_t> const& new_rows,
-                                             std::function<bool (int64_t)> key_did_change);
+                                             std::function<bool (int64_t)> key_did_change,
+                                             size_t max_move_calculation_cost=default_max_move_calculation_cost);
+
+    // The minimum number of rows for which calculate_parallel() actually
+    // splits up the work. Below this the overhead of handing the work to
+    // other threads outweighs the time saved.
+    static constexpr size_t default_parallel_calculation_threshold = 100'000;
+
+    // Calculate the same changes as calculate(), but split the rows into
+    // ranges of keys which are sorted, merged and checked for modifications
+    // in parallel on `pool`, with the results then stitched together. Each
+    // range calls a separate copy of `key_did_change`, and the copies may be
+    // called concurrently. Falls back to calculate() if there are fewer than
+    // `parallel_threshold` rows.
+    static CollectionChangeBuilder calculate_parallel(std::vector<int64_t> const& old_rows,
+                                                      std::vector<int64_t> const& new_rows,
+                                                      std::function<bool (int64_t)> const& key_did_change,
+                                                      bool in_table_order,
+                                                      NotifierWorkerPool& pool,
+                                                      size_t parallel_threshold=default_parallel_calculation_threshold,
+                                                      size_t max_move_calculation_cost=default_max_move_calculation_cost);
 
     // generic operations {
     CollectionChangeSet finalize() &&;
@@ -67,12 +117,23 @@ public:
     void move(size_t from, size_t to);
     // }
 
+    // Move any index sets allocated from a ChunkArena to the heap
+    void detach_from_arena();
+
 private:
     bool m_track_columns = true;
 
     template<typename Func>
     void for_each_col(Func&& f);
 
+    // The implementation of calculate() for each type of checker
+    template<typename Checker>
+    static CollectionChangeBuilder calculate_rows(std::vector<int64_t> const& old_rows,
+                                                  std::vector<int64_t> const& new_rows,
+                                                  Checker& key_did_change,
+                                                  bool in_table_order,
+                                                  size_t max_move_calculation_cost);
+
     void verify();
 };
 } // namespace _impl
@@ -48,29 +48,16 @@ bool CollectionNotifier::all_related_tables_covered(const TableVersions& version
 
 std::function<bool (ObjectChangeSet::ObjectKeyType)>
 CollectionNotifier::get_modification_checker(TransactionChangeInfo const& info,
-                                             ConstTableRef root_table)
+                                             ConstTableRef root_table, size_t row_count)
 {
-    if (info.schema_changed)
-        set_table(root_table);
-
-    // First check if any of the tables accessible from the root table were
-    // actually modified. This can be false if there were only insertions, or
-    // deletions which were not linked to by any row in the linking table
-    auto table_modified = [&](auto& tbl) {
-        auto it = info.tables.find(tbl.table_key.value);
-        return it != info.tables.end() && !it->second.modifications_empty();
-    };
-    if (!any_of(begin(m_related_tables), end(m_related_tables), table_modified)) {
-        return [](ObjectChangeSet::ObjectKeyType) { return false; };
-    }
-    if (m_related_tables.size() == 1) {
-        auto& object_set = info.tables.find(m_related_tables[0].table_key.value)->second;
-        return [&](ObjectChangeSet::ObjectKeyType object_key) { return object_set.modifications_contains(object_key); };
-    }
-
-    return DeepChangeChecker(info, *root_table, m_related_tables);
+    return with_modification_checker(info, root_table, row_count, [](auto& checker) {
+        return std::function<bool (ObjectChangeSet::ObjectKeyType)>(checker);
+    });
 }
 
+constexpr size_t DeepChangeChecker::default_max_depth;
+constexpr size_t DeepChangeChecker::backlink_row_ratio;
+
 void DeepChangeChecker::find_related_tables(std::vector<RelatedTable>& out, Table const& table)
 {
     auto table_key = table.get_key();
@@ -82,7 +69,7 @@ void DeepChangeChecker::find_related_tables(std::vector<RelatedTable>& out, Tabl
     // because the recursive calls may resize `out`, so instead look it up by
     // index every time
     size_t out_index = out.size();
-    out.push_back({table_key, {}});
+    out.push_back({table_key, {}, {}});
 
     for (auto col_key : table.get_column_keys()) {
         auto type = table.get_column_type(col_key);
@@ -95,7 +82,8 @@ void DeepChangeChecker::find_related_tables(std::vector<RelatedTable>& out, Tabl
 
 DeepChangeChecker::DeepChangeChecker(TransactionChangeInfo const& info,
                                      Table const& root_table,
-                                     std::vector<RelatedTable> const& related_tables)
+                                     std::vector<RelatedTable> const& related_tables,
+                                     size_t row_count, size_t max_depth, Strategy strategy)
 : m_info(info)
 , m_root_table(root_table)
 , m_root_table_key(root_table.get_key().value)
@@ -104,14 +92,111 @@ DeepChangeChecker::DeepChangeChecker(TransactionChangeInfo const& info,
     return it != info.tables.end() ? &it->second : nullptr;
 }())
 , m_related_tables(related_tables)
+, m_current_path(std::max<size_t>(max_depth, 1))
+, m_use_backlinks(strategy == Strategy::Backlinks)
 {
+    auto root = find_related_table(m_root_table_key);
+    if (root != m_related_tables.end())
+        m_root_columns = root->columns;
+
+    if (strategy != Strategy::Automatic || row_count == 0)
+        return;
+
+    size_t modification_count = 0;
+    for (auto& tbl : m_related_tables) {
+        auto it = m_info.tables.find(tbl.table_key.value);
+        if (it != m_info.tables.end())
+            modification_count += it->second.modifications_size();
+    }
+    m_use_backlinks = modification_count * backlink_row_ratio <= row_count;
+}
+
+std::vector<DeepChangeChecker::RelatedTable>::const_iterator
+DeepChangeChecker::find_related_table(TableKey table_key) const
+{
+    return find_if(begin(m_related_tables), end(m_related_tables),
+                   [&](auto&& tbl) { return tbl.table_key == table_key; });
+}
+
+void DeepChangeChecker::find_modified_root_objects()
+{
+    // Look up each of the related tables by following the links from the
+    // root table, and build a list of the links into each table
+    struct IncomingLink {
+        Table const* origin;
+        ColKey col_key;
+    };
+    std::unordered_map<TableKeyType, Table const*> tables;
+    std::unordered_map<TableKeyType, std::vector<IncomingLink>> incoming_links;
+    std::vector<Table const*> to_visit = {&m_root_table};
+    tables[m_root_table_key.value] = &m_root_table;
+    while (!to_visit.empty()) {
+        auto& table = *to_visit.back();
+        to_visit.pop_back();
+        auto it = find_related_table(table.get_key());
+        if (it == m_related_tables.end())
+            continue;
+        for (auto& link : it->links) {
+            auto& target = *table.get_link_target(ColKey(link.col_key));
+            incoming_links[target.get_key().value].push_back({&table, ColKey(link.col_key)});
+            if (tables.emplace(target.get_key().value, &target).second)
+                to_visit.push_back(&target);
+        }
+    }
+
+    // Walk backwards from the modified objects one link at a time, so that
+    // each object is reached first via the shortest chain of links and the
+    // depth limit matches the forward search
+    struct Object {
+        Table const* table;
+        ObjKeyType obj_key;
+    };
+    std::vector<Object> current, next;
+    std::unordered_map<TableKeyType, ObjectKeySet> seen;
+    for (auto& table : tables) {
+        auto it = m_info.tables.find(table.first);
+        if (it == m_info.tables.end() || it->second.modifications_empty())
+            continue;
+        auto related = find_related_table(TableKey(table.first));
+        auto columns = related != m_related_tables.end() ? related->columns : std::vector<int64_t>();
+        auto& seen_in_table = seen[table.first];
+        for (auto& modification : it->second.get_modifications()) {
+            if (!it->second.modifications_contains(modification.first, columns))
+                continue;
+            seen_in_table.insert(modification.first);
+            current.push_back({table.second, modification.first});
+        }
+    }
+
+    for (size_t depth = 1; depth < m_current_path.size() && !current.empty(); ++depth) {
+        for (auto& object : current) {
+            auto links = incoming_links.find(object.table->get_key().value);
+            if (links == incoming_links.end() || !object.table->is_valid(ObjKey(object.obj_key)))
+                continue;
+            ConstObj obj = object.table->get_object(ObjKey(object.obj_key));
+            for (auto& link : links->second) {
+                auto& seen_in_origin = seen[link.origin->get_key().value];
+                size_t count = obj.get_backlink_count(*link.origin, link.col_key);
+                for (size_t i = 0; i < count; ++i) {
+                    auto origin_key = obj.get_backlink(*link.origin, link.col_key, i).value;
+                    if (!seen_in_origin.insert(origin_key).second)
+                        continue;
+                    next.push_back({link.origin, origin_key});
+                    if (link.origin == &m_root_table)
+                        m_modified_root_objects.insert(origin_key);
+                }
+            }
+        }
+        current.swap(next);
+        next.clear();
+    }
+    m_found_modified_root_objects = true;
 }
 
 bool DeepChangeChecker::check_outgoing_links(TableKey table_key, Table const& table,
                                              int64_t obj_key, size_t depth)
 {
-    auto it = find_if(begin(m_related_tables), end(m_related_tables),
-                      [&](auto&& tbl) { return tbl.table_key == table_key; });
+    auto it = find_related_table(table_key);
     if (it == m_related_tables.end())
         return false;
     if (it->links.empty())
@@ -154,7 +239,6 @@ bool DeepChangeChecker::check_outgoing_links(TableKey table_key, Table const& ta
 
 bool DeepChangeChecker::check_row(Table const& table, ObjKeyType key, size_t depth)
 {
-    // Arbitrary upper limit on the maximum depth to search
     if (depth >= m_current_path.size()) {
         // Don't mark any of the intermediate rows checked along the path as
         // not modified, as a search starting from them might hit a modification
@@ -166,8 +250,11 @@ bool DeepChangeChecker::check_row(Table const& table, ObjKeyType key, size_t dep
     TableKey table_key = table.get_key();
     if (depth > 0) {
         auto it = m_info.tables.find(table_key.value);
-        if (it != m_info.tables.end() && it->second.modifications_contains(key))
-            return true;
+        if (it != m_info.tables.end() && it->second.modifications_contains(key)) {
+            auto related = find_related_table(table_key);
+            if (related == m_related_tables.end() || it->second.modifications_contains(key, related->columns))
+                return true;
+        }
     }
     auto& not_modified = m_not_modified[table_key.value];
     auto it = not_modified.find(key);
@@ -182,9 +269,13 @@ bool DeepChangeChecker::check_row(Table const& table, ObjKeyType key, size_t dep
 
 bool DeepChangeChecker::operator()(ObjKeyType key)
 {
-    if (m_root_object_changes && m_root_object_changes->modifications_contains(key))
+    if (m_root_object_changes && m_root_object_changes->modifications_contains(key, m_root_columns))
         return true;
-    return check_row(m_root_table, key, 0);
+    if (!m_use_backlinks)
+        return check_row(m_root_table, key, 0);
+    if (!m_found_modified_root_objects)
+        find_modified_root_objects();
+    return m_modified_root_objects.contains(key);
 }
 
 CollectionNotifier::CollectionNotifier(std::shared_ptr<Realm> realm)
@@ -197,7 +288,8 @@ CollectionNotifier::~CollectionNotifier()
 {
     // Need to do this explicitly to ensure m_realm is destroyed with the mutex
     // held to avoid potential double-deletion
-    unregister();
+    std::lock_guard<std::mutex> lock(m_realm_mutex);
+    m_realm = nullptr;
 }
 
 void CollectionNotifier::release_data() noexcept
@@ -205,13 +297,19 @@ void CollectionNotifier::release_data() noexcept
     m_sg = nullptr;
 }
 
-uint64_t CollectionNotifier::add_callback(CollectionChangeCallback callback)
+uint64_t CollectionNotifier::add_callback(CollectionChangeCallback callback,
+                                          std::chrono::milliseconds min_delivery_interval,
+                                          KeyPathArray key_path_array, uint64_t owner)
 {
     m_realm->verify_thread();
 
     util::CheckedLockGuard lock(m_callback_mutex);
     auto token = m_next_token++;
-    m_callbacks.push_back({std::move(callback), {}, {}, token, false, false});
+    auto callbacks = std::make_shared<CallbackList>(*m_callbacks.load());
+    callbacks->push_back(std::make_shared<Callback>(std::move(callback), token, min_delivery_interval,
+                                                    std::move(key_path_array), owner));
+    m_callbacks.exchange(std::move(callbacks));
+    m_key_paths_changed = true;
     if (m_callback_index == npos) { // Don't need to wake up if we're already sending notifications
         Realm::Internal::get_coordinator(*m_realm).wake_up_notifier_worker();
         m_have_callbacks = true;
@@ -222,26 +320,55 @@ uint64_t CollectionNotifier::add_callback(CollectionChangeCallback callback)
 void CollectionNotifier::remove_callback(uint64_t token)
 {
     // the callback needs to be destroyed after releasing the lock as destroying
-    // it could cause user code to be called
-    Callback old;
+    // it could cause user code to be called. If a delivery which includes
+    // the callback is in progress then it's instead destroyed when that
+    // finishes.
+    std::shared_ptr<Callback> old;
     {
         util::CheckedLockGuard lock(m_callback_mutex);
-        auto it = find_callback(token);
-        if (it == end(m_callbacks)) {
+        old = find_callback(token);
+        if (!old)
             return;
+        old->removed = true;
+
+        auto old_callbacks = m_callbacks.load();
+        auto callbacks = std::make_shared<CallbackList>();
+        callbacks->reserve(old_callbacks->size() - 1);
+        for (auto& callback : *old_callbacks) {
+            if (callback != old)
+                callbacks->push_back(callback);
         }
+        m_have_callbacks = !callbacks->empty();
+        m_callbacks.exchange(std::move(callbacks));
+        m_key_paths_changed = true;
+    }
+}
 
-        size_t idx = distance(begin(m_callbacks), it);
-        if (m_callback_index != npos) {
-            if (m_callback_index >= idx)
-                --m_callback_index;
+void CollectionNotifier::remove_owner_callbacks(uint64_t owner)
+{
+    // As in remove_callback(), the callbacks are destroyed after releasing
+    // the lock
+    CallbackList removed;
+    {
+        util::CheckedLockGuard lock(m_callback_mutex);
+        auto old_callbacks = m_callbacks.load();
+        auto callbacks = std::make_shared<CallbackList>();
+        for (auto& callback : *old_callbacks) {
+            if (callback->owner == owner) {
+                callback->removed = true;
+                removed.push_back(callback);
+            }
+            else {
+                callbacks->push_back(callback);
+            }
         }
-        --m_callback_count;
-
-        old = std::move(*it);
-        m_callbacks.erase(it);
+        if (removed.empty())
+            return;
 
-        m_have_callbacks = !m_callbacks.empty();
+        m_removed_owner_callbacks = true;
+        m_have_callbacks = !callbacks->empty();
+        m_callbacks.exchange(std::move(callbacks));
+        m_key_paths_changed = true;
     }
 }
 
@@ -254,28 +381,51 @@ void CollectionNotifier::suppress_next_notification(uint64_t token)
         m_realm->verify_in_write();
     }
 
-    util::CheckedLockGuard lock(m_callback_mutex);
-    auto it = find_callback(token);
-    if (it != end(m_callbacks)) {
-        it->skip_next = true;
-    }
+    if (auto callback = find_callback(token))
+        callback->skip_next = true;
+}
+
+std::shared_ptr<CollectionNotifier::Callback> CollectionNotifier::find_callback(uint64_t token) const
+{
+    auto callbacks = m_callbacks.load();
+    REALM_ASSERT(m_error || m_removed_owner_callbacks || !callbacks->empty());
+
+    auto it = find_if(begin(*callbacks), end(*callbacks),
+                      [=](auto const& c) { return c->token == token; });
+    // We should only fail to find the callback if it was removed due to an
+    // error or because the collection it was added through was destroyed
+    REALM_ASSERT(m_error || m_removed_owner_callbacks || it != end(*callbacks));
+    return it == end(*callbacks) ? nullptr : *it;
 }
 
-std::vector<CollectionNotifier::Callback>::iterator CollectionNotifier::find_callback(uint64_t token)
+void CollectionNotifier::unregister(uint64_t owner) noexcept
 {
-    REALM_ASSERT(m_error || m_callbacks.size() > 0);
+    {
+        std::lock_guard<std::mutex> lock(m_realm_mutex);
+        if (m_owner_count == 0 || --m_owner_count == 0) {
+            m_realm = nullptr;
+            return;
+        }
+    }
+    // Shared notifiers stay alive until every owner has unregistered, but the
+    // callbacks added through this owner must not be called again
+    if (owner)
+        remove_owner_callbacks(owner);
+}
 
-    auto it = find_if(begin(m_callbacks), end(m_callbacks),
-                      [=](const auto& c) { return c.token == token; });
-    // We should only fail to find the callback if it was removed due to an error
-    REALM_ASSERT(m_error || it != end(m_callbacks));
-    return it;
+bool CollectionNotifier::add_owner() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_realm_mutex);
+    if (!m_realm)
+        return false;
+    ++m_owner_count;
+    return true;
 }
 
-void CollectionNotifier::unregister() noexcept
+bool CollectionNotifier::is_shared() const noexcept
 {
     std::lock_guard<std::mutex> lock(m_realm_mutex);
-    m_realm = nullptr;
+    return m_owner_count > 1;
 }
 
 bool CollectionNotifier::is_alive() const noexcept
@@ -291,12 +441,117 @@ std::unique_lock<std::mutex> CollectionNotifier::lock_target()
 
 void CollectionNotifier::set_table(ConstTableRef table)
 {
-    m_related_tables.clear();
-    DeepChangeChecker::find_related_tables(m_related_tables, *table);
+    m_all_related_tables.clear();
+    DeepChangeChecker::find_related_tables(m_all_related_tables, *table);
+    apply_key_path_filter();
+}
+
+void CollectionNotifier::update_key_path_filter()
+{
+    // A callback without a filter needs every change, so the combined filter
+    // is only used if every callback has one
+    m_key_path_array.clear();
+    m_key_path_filters.clear();
+    auto callbacks = m_callbacks.load();
+    bool all_filtered = true;
+    for (auto& callback : *callbacks) {
+        callback->key_path_filter_index = npos;
+        // Key paths which aren't valid for this collection are ignored
+        auto related_tables = related_tables_for(callback->key_path_array);
+        if (related_tables.empty() || related_tables.front().columns.empty()) {
+            all_filtered = false;
+            continue;
+        }
+
+        // Callbacks which have the same filter share the change calculated for it
+        auto it = find_if(begin(m_key_path_filters), end(m_key_path_filters),
+                          [&](auto& filter) { return filter.key_path_array == callback->key_path_array; });
+        callback->key_path_filter_index = it - m_key_path_filters.begin();
+        if (it == m_key_path_filters.end())
+            m_key_path_filters.push_back({callback->key_path_array, {}, util::none});
+        if (all_filtered)
+            m_key_path_array.insert(m_key_path_array.end(), callback->key_path_array.begin(),
+                                    callback->key_path_array.end());
+    }
+    if (!all_filtered)
+        m_key_path_array.clear();
+
+    // If every callback has the same filter then m_change is already exactly
+    // what they all need
+    if (all_filtered && m_key_path_filters.size() == 1) {
+        m_key_path_filters.clear();
+        for (auto& callback : *callbacks)
+            callback->key_path_filter_index = npos;
+    }
+    apply_key_path_filter();
+}
+
+void CollectionNotifier::apply_key_path_filter()
+{
+    m_related_tables = related_tables_for(m_key_path_array);
+    for (auto& filter : m_key_path_filters)
+        filter.related_tables = related_tables_for(filter.key_path_array);
+}
+
+std::vector<DeepChangeChecker::RelatedTable>
+CollectionNotifier::related_tables_for(KeyPathArray const& key_path_array) const
+{
+    if (key_path_array.empty() || m_all_related_tables.empty())
+        return m_all_related_tables;
+
+    // Build the related tables from just the tables, columns and links which
+    // appear in the key paths. The first entry is always the root table.
+    auto root_key = m_all_related_tables.front().table_key;
+    std::vector<DeepChangeChecker::RelatedTable> related_tables;
+    related_tables.push_back({root_key, {}, {}});
+    for (auto& key_path : key_path_array) {
+        if (key_path.empty() || key_path.front().first != root_key)
+            continue;
+        for (size_t i = 0; i < key_path.size(); ++i) {
+            auto table_key = key_path[i].first;
+            auto col_key = key_path[i].second.value;
+            auto all = find_if(begin(m_all_related_tables), end(m_all_related_tables),
+                               [&](auto& tbl) { return tbl.table_key == table_key; });
+            if (all == m_all_related_tables.end())
+                break;
+
+            auto related = find_if(begin(related_tables), end(related_tables),
+                                   [&](auto& tbl) { return tbl.table_key == table_key; });
+            if (related == related_tables.end())
+                related = related_tables.insert(related, {table_key, {}, {}});
+            if (std::find(related->columns.begin(), related->columns.end(), col_key) == related->columns.end())
+                related->columns.push_back(col_key);
+
+            if (i + 1 == key_path.size())
+                break;
+            auto link = find_if(begin(all->links), end(all->links),
+                                [&](auto& outgoing) { return outgoing.col_key == col_key; });
+            if (link == all->links.end())
+                break;
+            auto has_link = any_of(begin(related->links), end(related->links),
+                                   [&](auto& outgoing) { return outgoing.col_key == col_key; });
+            if (!has_link)
+                related->links.push_back(*link);
+        }
+    }
+
+    // None of the key paths were valid for this table
+    if (related_tables.front().columns.empty())
+        return m_all_related_tables;
+    return related_tables;
+}
+
+std::vector<int64_t> const& CollectionNotifier::filtered_root_columns() const noexcept
+{
+    static const std::vector<int64_t> all_columns;
+    return m_related_tables.empty() ? all_columns : m_related_tables.front().columns;
 }
 
 void CollectionNotifier::add_required_change_info(TransactionChangeInfo& info)
 {
+    if (m_key_paths_changed.exchange(false))
+        update_key_path_filter();
+
     if (!do_add_required_change_info(info) || m_related_tables.empty()) {
         return;
     }
@@ -306,53 +561,75 @@ void CollectionNotifier::add_required_change_info(TransactionChangeInfo& info)
         info.tables[tbl.table_key.value];
 }
 
+namespace {
+// Remove the per-column modifications for the columns which a key path
+// filter doesn't start with
+void remove_unfiltered_columns(CollectionChangeBuilder& change, std::vector<int64_t> const& root_columns)
+{
+    for (auto it = change.columns.begin(); it != change.columns.end();) {
+        if (std::find(root_columns.begin(), root_columns.end(), it->first) == root_columns.end())
+            it = change.columns.erase(it);
+        else
+            ++it;
+    }
+}
+} // anonymous namespace
+
 void CollectionNotifier::prepare_handover()
 {
     REALM_ASSERT(m_sg);
     m_sg_version = m_sg->get_version_of_current_transaction();
     do_prepare_handover(*m_sg);
+    // The changes may have been built in the notifier run's arena, which is
+    // freed once every notifier has been handed over
+    m_change.detach_from_arena();
+    if (has_key_path_filter())
+        remove_unfiltered_columns(m_change, filtered_root_columns());
+    for (auto& filter : m_key_path_filters) {
+        if (!filter.change)
+            filter.change = m_change;
+        remove_unfiltered_columns(*filter.change, filter.related_tables.front().columns);
+        filter.change->detach_from_arena();
+    }
     add_changes(std::move(m_change));
     REALM_ASSERT(m_change.empty());
     m_has_run = true;
 
 #ifdef REALM_DEBUG
-    util::CheckedLockGuard lock(m_callback_mutex);
-    for (auto& callback : m_callbacks)
-        REALM_ASSERT(!callback.skip_next);
+    for (auto& callback : *m_callbacks.load())
+        REALM_ASSERT(!callback->skip_next);
 #endif
 }
 
 void CollectionNotifier::before_advance()
 {
-    for_each_callback([&](auto& lock, auto& callback) {
+    LatencyHistogram::Timer timer(timings(&NotifierStatistics::before_advance));
+    for_each_callback([&](auto& callback) {
         if (callback.changes_to_deliver.empty()) {
             return;
         }
 
+        // the callback can refresh the Realm, which repackages the changes
         auto changes = callback.changes_to_deliver;
-        // acquire a local reference to the callback so that removing the
-        // callback from within it can't result in a dangling pointer
         auto cb = callback.fn;
-        lock.unlock_unchecked();
         cb.before(changes);
     });
 }
 
 void CollectionNotifier::after_advance()
 {
-    for_each_callback([&](auto& lock, auto& callback) {
+    LatencyHistogram::Timer timer(timings(&NotifierStatistics::after_advance));
+    for_each_callback([&](auto& callback) {
         if (callback.initial_delivered && callback.changes_to_deliver.empty()) {
             return;
         }
         callback.initial_delivered = true;
 
         auto changes = std::move(callback.changes_to_deliver);
-        // acquire a local reference to the callback so that removing the
-        // callback from within it can't result in a dangling pointer
         auto cb = callback.fn;
-        lock.unlock_unchecked();
         cb.after(changes);
     });
+    m_delivery_callbacks.reset();
 }
 
 void CollectionNotifier::deliver_error(std::exception_ptr error)
@@ -360,18 +637,16 @@ void CollectionNotifier::deliver_error(std::exception_ptr error)
     // Don't complain about double-unregistering callbacks
     m_error = true;
 
-    m_callback_count = m_callbacks.size();
-    for_each_callback([this, &error](auto& lock, auto& callback) {
-        // acquire a local reference to the callback so that removing the
-        // callback from within it can't result in a dangling pointer
+    m_delivery_callbacks = m_callbacks.load();
+    for_each_callback([this, &error](auto& callback) {
         auto cb = std::move(callback.fn);
         auto token = callback.token;
-        lock.unlock_unchecked();
         cb.error(error);
 
         // We never want to call the callback again after this, so just remove it
         this->remove_callback(token);
     });
+    m_delivery_callbacks.reset();
 }
 
 bool CollectionNotifier::is_for_realm(Realm& realm) const noexcept
@@ -382,24 +657,54 @@ bool CollectionNotifier::is_for_realm(Realm& realm) const noexcept
 
 bool CollectionNotifier::package_for_delivery()
 {
+    LatencyHistogram::Timer timer(timings(&NotifierStatistics::package_for_delivery));
     if (!prepare_to_deliver())
         return false;
-    util::CheckedLockGuard lock(m_callback_mutex);
-    for (auto& callback : m_callbacks)
-        callback.changes_to_deliver = std::move(callback.accumulated_changes).finalize();
-    m_callback_count = m_callbacks.size();
+
+    auto now = Clock::now();
+    auto wake_up_at = Clock::time_point::max();
+    auto callbacks = m_callbacks.load();
+    for (auto& callback : *callbacks) {
+        if (now < callback->next_delivery) {
+            // Leave the changes in accumulated_changes so that any further
+            // changes are merged into them until the interval has passed
+            callback->changes_to_deliver = {};
+            if (!callback->accumulated_changes.empty())
+                wake_up_at = std::min(wake_up_at, callback->next_delivery);
+            continue;
+        }
+
+        callback->changes_to_deliver = std::move(callback->accumulated_changes).finalize();
+        if (!callback->changes_to_deliver.empty())
+            callback->next_delivery = now + callback->min_delivery_interval;
+    }
+    m_delivery_callbacks = std::move(callbacks);
+
+    // Don't ask for another wake up if there's already one coming soon enough
+    if (wake_up_at == Clock::time_point::max() || (now < m_scheduled_delivery && m_scheduled_delivery <= wake_up_at))
+        return true;
+    m_scheduled_delivery = wake_up_at;
+
+    // Nothing else will trigger delivering the held back changes if there
+    // are no more commits, so the coordinator needs to do it
+    auto lock = lock_target();
+    if (m_realm)
+        Realm::Internal::get_coordinator(*m_realm).notify_realms_at(wake_up_at);
     return true;
 }
 
 template<typename Fn>
 void CollectionNotifier::for_each_callback(Fn&& fn)
 {
-    util::CheckedUniqueLock callback_lock(m_callback_mutex);
-    REALM_ASSERT_DEBUG(m_callback_count <= m_callbacks.size());
-    for (++m_callback_index; m_callback_index < m_callback_count; ++m_callback_index) {
-        fn(callback_lock, m_callbacks[m_callback_index]);
-        if (!callback_lock.owns_lock())
-            callback_lock.lock_unchecked();
+    // Hold references to the list and to each callback so that they stay
+    // alive if the callback removes itself or refreshes the Realm
+    auto callbacks = m_delivery_callbacks;
+    if (callbacks) {
+        for (++m_callback_index; m_callback_index < callbacks->size(); ++m_callback_index) {
+            auto callback = (*callbacks)[m_callback_index];
+            if (!callback->removed)
+                fn(*callback);
+        }
     }
 
     m_callback_index = npos;
@@ -418,19 +723,27 @@ Transaction& CollectionNotifier::source_shared_group()
 
 void CollectionNotifier::add_changes(CollectionChangeBuilder change)
 {
-    util::CheckedLockGuard lock(m_callback_mutex);
-    for (auto& callback : m_callbacks) {
-        if (callback.skip_next) {
-            REALM_ASSERT_DEBUG(callback.accumulated_changes.empty());
-            callback.skip_next = false;
-        }
-        else {
-            if (&callback == &m_callbacks.back())
-                callback.accumulated_changes.merge(std::move(change));
-            else
-                callback.accumulated_changes.merge(CollectionChangeBuilder(change));
-        }
+    auto callbacks = m_callbacks.load();
+    for (auto& callback : *callbacks) {
+        // A skipped change can only be dropped if no earlier changes are being
+        // held back for the callback, as the held back indices would otherwise
+        // no longer match the collection, so it's merged into them instead
+        if (callback->skip_next.exchange(false) && callback->accumulated_changes.empty())
+            continue;
+
+        // Callbacks with a narrower key path filter than the combined one get
+        // the change calculated for their filter
+        auto* source = &change;
+        size_t filter_index = callback->key_path_filter_index;
+        if (filter_index < m_key_path_filters.size() && m_key_path_filters[filter_index].change)
+            source = &*m_key_path_filters[filter_index].change;
+        if (&callback == &callbacks->back())
+            callback->accumulated_changes.merge(std::move(*source));
+        else
+            callback->accumulated_changes.merge(CollectionChangeBuilder(*source));
     }
+    for (auto& filter : m_key_path_filters)
+        filter.change = util::none;
 }
 
 NotifierPackage::NotifierPackage(std::exception_ptr error,
@@ -495,6 +808,5 @@ void NotifierPackage::after_advance()
 
 void NotifierPackage::add_notifier(std::shared_ptr<CollectionNotifier> notifier)
 {
-    m_notifiers.push_back(notifier);
-    m_coordinator->register_notifier(notifier);
+    m_notifiers.push_back(m_coordinator->register_notifier(std::move(notifier)));
 }
@@ -21,15 +21,20 @@
 
 #include "object_changeset.hpp"
 #include "impl/collection_change_builder.hpp"
+#include "impl/notifier_statistics.hpp"
+#include "util/atomic_shared_ptr.hpp"
 #include "util/checked_mutex.hpp"
 
 #include <realm/util/assert.hpp>
+#include <realm/util/optional.hpp>
 #include <realm/version_id.hpp>
 #include <realm/keys.hpp>
 #include <realm/table_ref.hpp>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <functional>
 #include <mutex>
@@ -61,6 +66,18 @@ struct TransactionChangeInfo {
     bool schema_changed;
 };
 
+// Checks whether an object in a collection's table was modified, either
+// directly or via a modification to an object reachable from it through a
+// chain of links.
+//
+// There are two ways of doing this. The forward strategy searches the links
+// from each object which is checked, caching the objects found to not have
+// been modified. The backlink strategy instead starts from the modified
+// objects and follows backlinks towards the root table, finding every
+// modified object in the root table once up front. The backlink strategy is
+// much cheaper when a large collection links into a graph of objects of
+// which only a few were modified, while the forward strategy is cheaper when
+// only a few objects are checked against many modifications.
 class DeepChangeChecker {
 public:
     struct OutgoingLink {
@@ -70,10 +87,33 @@ public:
     struct RelatedTable {
         TableKey table_key;
         std::vector<OutgoingLink> links;
+        // The columns whose modifications count as the object being modified,
+        // or empty for all columns
+        std::vector<int64_t> columns;
+    };
+
+    enum class Strategy {
+        // Pick the backlink strategy when the number of modified objects is
+        // small relative to `row_count`, and otherwise the forward strategy
+        Automatic,
+        Forward,
+        Backlinks,
     };
 
+    // The default maximum number of objects in a chain of links starting
+    // from the root object, including the root object itself. Modifications
+    // to objects further away than this are not reported.
+    static constexpr size_t default_max_depth = 4;
+    // The automatic strategy uses backlinks when there are at least this
+    // many rows being checked for each modified object
+    static constexpr size_t backlink_row_ratio = 8;
+
+    // `row_count` is the number of rows which are expected to be checked, or
+    // zero if that's not known.
     DeepChangeChecker(TransactionChangeInfo const& info, Table const& root_table,
-                      std::vector<RelatedTable> const& related_tables);
+                      std::vector<RelatedTable> const& related_tables,
+                      size_t row_count=0, size_t max_depth=default_max_depth,
+                      Strategy strategy=Strategy::Automatic);
 
     bool operator()(int64_t obj_key);
 
@@ -81,6 +121,8 @@ public:
     // information about the links from them
     static void find_related_tables(std::vector<RelatedTable>& out, Table const& table);
 
+    bool uses_backlinks() const noexcept { return m_use_backlinks; }
+
 private:
     TransactionChangeInfo const& m_info;
     Table const& m_root_table;
@@ -88,19 +130,97 @@ private:
     ObjectChangeSet const* const m_root_object_changes;
     std::unordered_map<TableKeyType, std::unordered_set<ObjKeyType>> m_not_modified;
     std::vector<RelatedTable> const& m_related_tables;
+    std::vector<int64_t> m_root_columns;
 
     struct Path {
         int64_t obj_key;
         int64_t col_key;
         bool depth_exceeded;
     };
-    std::array<Path, 4> m_current_path;
+    std::vector<Path> m_current_path;
+
+    bool m_use_backlinks;
+    // The objects in the root table which link to a modified object, built
+    // on first use when using backlinks
+    ObjectKeySet m_modified_root_objects;
+    bool m_found_modified_root_objects = false;
 
     bool check_row(Table const& table, ObjKeyType obj_key, size_t depth = 0);
     bool check_outgoing_links(TableKey table_key, Table const& table,
                               int64_t obj_key, size_t depth = 0);
+    void find_modified_root_objects();
+    std::vector<RelatedTable>::const_iterator find_related_table(TableKey table_key) const;
+};
+
+// Used in place of a DeepChangeChecker when none of the tables which a
+// collection depends on were modified
+struct NoChangesChecker {
+    bool operator()(ObjKeyType) const noexcept { return false; }
 };
 
+// Used in place of a DeepChangeChecker when the collection's table has no
+// outgoing links, so an object was only modified if it's in the table's own
+// modifications
+class TableChangeChecker {
+public:
+    // Only modifications to `columns` are reported if it's non-empty
+    TableChangeChecker(ObjectChangeSet const& changes, std::vector<int64_t> columns={})
+    : m_changes(changes), m_columns(std::move(columns)) { }
+
+    bool operator()(ObjKeyType obj_key) const { return m_changes.modifications_contains(obj_key, m_columns); }
+
+    // Call `fn(i)` for the offset from `first` of each modified key in
+    // [first, last), which must be sorted and unique. Rather than looking up
+    // each key, this walks the sorted modified keys which fall in the range,
+    // which is much cheaper when only a few of the keys were modified.
+    template<typename Iterator, typename Fn>
+    void for_each_modified(Iterator first, Iterator last, Fn&& fn);
+
+private:
+    ObjectChangeSet const& m_changes;
+    std::vector<int64_t> m_columns;
+    // The keys of the modified objects in ascending order, built on first use
+    std::vector<ObjKeyType> m_sorted_modifications;
+    bool m_did_sort = false;
+};
+
+template<typename Iterator, typename Fn>
+void TableChangeChecker::for_each_modified(Iterator first, Iterator last, Fn&& fn)
+{
+    if (first == last)
+        return;
+    if (!m_did_sort) {
+        m_sorted_modifications.reserve(m_changes.modifications_size());
+        for (auto& modification : m_changes.get_modifications()) {
+            if (m_columns.empty() || m_changes.modifications_contains(modification.first, m_columns))
+                m_sorted_modifications.push_back(modification.first);
+        }
+        std::sort(m_sorted_modifications.begin(), m_sorted_modifications.end());
+        m_did_sort = true;
+    }
+
+    auto mod = std::lower_bound(m_sorted_modifications.begin(), m_sorted_modifications.end(), *first);
+    auto mod_end = std::upper_bound(mod, m_sorted_modifications.end(), *(last - 1));
+
+    // Binary search for each modified key when they're sparse, and otherwise
+    // just walk both sequences
+    bool sparse = size_t(mod_end - mod) * 16 < size_t(last - first);
+    auto it = first;
+    while (mod != mod_end && it != last) {
+        if (sparse)
+            it = std::lower_bound(it, last, *mod);
+        else
+            while (it != last && *it < *mod) ++it;
+        if (it == last)
+            break;
+        if (*it == *mod) {
+            fn(size_t(it - first));
+            ++it;
+        }
+        ++mod;
+    }
+}
+
 // A base class for a notifier that keeps a collection up to date and/or
 // generates detailed change notifications on a background thread. This manages
 // most of the lifetime-management issues related to sharing an object between
@@ -115,19 +235,33 @@ public:
     // Public API for the collections using this to get notifications:
 
     // Stop receiving notifications from this background worker
-    // This must be called in the destructor of the collection
-    void unregister() noexcept;
+    // This must be called in the destructor of the collection, once for each
+    // owner of the notifier. If other owners are still using the notifier,
+    // the callbacks which were added with the given `owner` are removed.
+    void unregister(uint64_t owner=0) noexcept REQUIRES(!m_callback_mutex);
 
     // Add a callback to be called each time the collection changes
     // This can only be called from the target collection's thread
     // Returns a token which can be passed to remove_callback()
-    uint64_t add_callback(CollectionChangeCallback callback) REQUIRES(!m_callback_mutex);
+    // If `min_delivery_interval` is non-zero, changes which occur less than
+    // that long after the callback was last called are held back and merged
+    // into a single changeset which is delivered once the interval has passed.
+    // A suppressed notification for a write made while changes are held back
+    // is merged into them rather than skipped.
+    // If `key_path_array` is non-empty, only modifications to the columns in
+    // it are reported to this callback, and it is not called for changes
+    // which consist only of other modifications.
+    // `owner` is an id from new_owner_id() for the collection which added
+    // the callback, or zero.
+    uint64_t add_callback(CollectionChangeCallback callback,
+                          std::chrono::milliseconds min_delivery_interval={},
+                          KeyPathArray key_path_array={}, uint64_t owner=0) REQUIRES(!m_callback_mutex);
     // Remove a previously added token. The token is no longer valid after
     // calling this function and must not be used again. This function can be
     // called from any thread.
     void remove_callback(uint64_t token) REQUIRES(!m_callback_mutex);
 
-    void suppress_next_notification(uint64_t token) REQUIRES(!m_callback_mutex);
+    void suppress_next_notification(uint64_t token);
 
     // ------------------------------------------------------------------------
     // API for RealmCoordinator to manage running things and calling callbacks
@@ -135,6 +269,20 @@ public:
     bool is_for_realm(Realm&) const noexcept;
     Realm* get_realm() const noexcept { return m_realm.get(); }
 
+    // Check if this notifier will produce exactly the same results and
+    // changes as `other`, and so can be used in place of it. `other` must not
+    // have been registered with the coordinator yet.
+    virtual bool can_share(CollectionNotifier const&) const { return false; }
+
+    // Add another owner to a notifier which is being shared. The notifier
+    // then stays alive until unregister() has been called once per owner.
+    // Returns false if the notifier has already been unregistered.
+    bool add_owner() noexcept;
+    bool is_shared() const noexcept;
+    // An id to tag the callbacks added by one owner with. Only called on the
+    // target thread, as are all of the owners of a shared notifier.
+    uint64_t new_owner_id() noexcept { return ++m_last_owner_id; }
+
     // Get the Transaction version which this collection can attach to (if it's
     // in handover mode), or can deliver to (if it's been handed over to the BG worker alredad)
     // precondition: RealmCoordinator::m_notifier_mutex is locked
@@ -149,16 +297,16 @@ public:
     // Prepare to deliver the new collection and call callbacks.
     // Returns whether or not it has anything to deliver.
     // precondition: RealmCoordinator::m_notifier_mutex is locked
-    bool package_for_delivery() REQUIRES(!m_callback_mutex);
+    bool package_for_delivery();
 
     // Pass the given error to all registered callbacks, then remove them
     // precondition: RealmCoordinator::m_notifier_mutex is unlocked
-    void deliver_error(std::exception_ptr) REQUIRES(!m_callback_mutex);
+    void deliver_error(std::exception_ptr);
 
     // Call each of the given callbacks with the changesets prepared by package_for_delivery()
     // precondition: RealmCoordinator::m_notifier_mutex is unlocked
-    void before_advance() REQUIRES(!m_callback_mutex);
-    void after_advance() REQUIRES(!m_callback_mutex);
+    void before_advance();
+    void after_advance();
 
     bool is_alive() const noexcept;
 
@@ -177,21 +325,90 @@ public:
     // precondition: RealmCoordinator::m_notifier_mutex is unlocked
     virtual void run() = 0;
 
+    // The group of notifiers this notifier is run with when notifiers are
+    // being run in parallel. Assigned by RealmCoordinator when the notifier is
+    // first attached to the notifier Transaction.
     // precondition: RealmCoordinator::m_notifier_mutex is locked
-    void prepare_handover() REQUIRES(!m_callback_mutex);
+    size_t worker_index() const noexcept { return m_worker_index; }
+    void set_worker_index(size_t index) noexcept { m_worker_index = index; }
+
+    // Where to record the timings for this notifier. Set by RealmCoordinator
+    // when the notifier is registered.
+    void set_statistics(NotifierStatistics* statistics) noexcept { m_statistics = statistics; }
+
+    // The maximum number of objects in a chain of links which is followed
+    // when looking for modifications to the objects in the collection. Set
+    // by RealmCoordinator when the notifier is registered.
+    void set_max_link_depth(size_t depth) noexcept { m_max_link_depth = depth; }
+    size_t max_link_depth() const noexcept { return m_max_link_depth; }
+
+    // A pool which run() may use to split up its own work, or null. Set by
+    // RealmCoordinator around run() only when the pool isn't already busy
+    // running notifier groups.
+    void set_worker_pool(NotifierWorkerPool* pool) noexcept { m_worker_pool = pool; }
+
+    // precondition: RealmCoordinator::m_notifier_mutex is locked
+    void prepare_handover();
 
     template <typename T>
     class Handle;
 
     bool have_callbacks() const noexcept { return m_have_callbacks; }
 protected:
-    void add_changes(CollectionChangeBuilder change) REQUIRES(!m_callback_mutex);
+    void add_changes(CollectionChangeBuilder change);
     void set_table(ConstTableRef table);
     std::unique_lock<std::mutex> lock_target();
+    // The related tables after applying the callbacks' combined key path filter
+    std::vector<DeepChangeChecker::RelatedTable> const& related_tables() const noexcept { return m_related_tables; }
+    NotifierWorkerPool* worker_pool() const noexcept { return m_worker_pool; }
+
+    // A key path filter which some of the callbacks have and which is
+    // narrower than the combined filter. These only exist when the callbacks
+    // don't all have the same filter.
+    struct KeyPathFilter {
+        KeyPathArray key_path_array;
+        std::vector<DeepChangeChecker::RelatedTable> related_tables;
+        // The change for the callbacks with this filter, calculated in run()
+        // alongside m_change. If run() doesn't calculate it, those callbacks
+        // are sent m_change instead.
+        util::Optional<CollectionChangeBuilder> change;
+    };
+    std::vector<KeyPathFilter>& key_path_filters() noexcept { return m_key_path_filters; }
+    // Calculate the change for each of the key path filters from m_change by
+    // removing the modifications which the filter doesn't match. `key_at(i)`
+    // must return the key of the object at index `i` in the new version of
+    // the collection.
+    template<typename KeyAt>
+    void calculate_filtered_changes(TransactionChangeInfo const&, ConstTableRef, size_t row_count, KeyAt&& key_at);
+
+    // Whether any modifications are being filtered out by key paths
+    bool has_key_path_filter() const noexcept { return !filtered_root_columns().empty(); }
+    // The columns of the collection's table whose modifications are reported,
+    // or empty if all of them are
+    std::vector<int64_t> const& filtered_root_columns() const noexcept;
     Transaction& source_shared_group();
 
     bool all_related_tables_covered(const TableVersions& versions);
-    std::function<bool (ObjectChangeSet::ObjectKeyType)> get_modification_checker(TransactionChangeInfo const&, ConstTableRef);
+    // The histogram in the coordinator's statistics for the given stage, or
+    // null if the notifier has no statistics. For use with LatencyHistogram::Timer.
+    LatencyHistogram* timings(LatencyHistogram NotifierStatistics::* stage) const noexcept
+    {
+        return m_statistics ? &(m_statistics->*stage) : nullptr;
+    }
+    // `row_count` is the number of rows which will be checked, if known, and
+    // is used to pick a DeepChangeChecker strategy
+    std::function<bool (ObjectChangeSet::ObjectKeyType)> get_modification_checker(TransactionChangeInfo const&, ConstTableRef,
+                                                                                   size_t row_count=0);
+    // Call `fn` with the cheapest modification checker which works for this
+    // notifier's related tables: a NoChangesChecker, a TableChangeChecker or a
+    // DeepChangeChecker. Returns whatever `fn` returns.
+    template<typename Fn>
+    auto with_modification_checker(TransactionChangeInfo const&, ConstTableRef, size_t row_count, Fn&& fn);
+    // As above, but for the given related tables rather than the ones for
+    // the combined key path filter
+    template<typename Fn>
+    auto with_modification_checker(TransactionChangeInfo const&, ConstTableRef, size_t row_count,
+                                   std::vector<DeepChangeChecker::RelatedTable> const& related_tables, Fn&& fn);
 
     // The actual change, calculated in run() and delivered in prepare_handover()
     CollectionChangeBuilder m_change;
@@ -204,51 +421,166 @@ private:
 
     mutable std::mutex m_realm_mutex;
     std::shared_ptr<Realm> m_realm;
+    // The number of collections using this notifier, guarded by m_realm_mutex
+    size_t m_owner_count = 1;
 
     VersionID m_sg_version;
     std::shared_ptr<Transaction> m_sg;
 
+    size_t m_worker_index = 0;
+    NotifierStatistics* m_statistics = nullptr;
+    size_t m_max_link_depth = DeepChangeChecker::default_max_depth;
+    NotifierWorkerPool* m_worker_pool = nullptr;
+
     bool m_has_run = false;
     bool m_error = false;
+    // Set when unregister() removes an owner's callbacks, whose tokens may
+    // still be used afterwards
+    std::atomic<bool> m_removed_owner_callbacks{false};
+    // Every table reachable from the collection's table, and the subset of
+    // them which the key path filter refers to
+    std::vector<DeepChangeChecker::RelatedTable> m_all_related_tables;
     std::vector<DeepChangeChecker::RelatedTable> m_related_tables;
+    // The combined key path filter of all of the callbacks, which is updated
+    // on the worker thread when the callbacks have changed. Empty if any of
+    // the callbacks has no filter.
+    KeyPathArray m_key_path_array;
+    std::vector<KeyPathFilter> m_key_path_filters;
+    std::atomic<bool> m_key_paths_changed{false};
+
+    using Clock = std::chrono::steady_clock;
 
     struct Callback {
+        Callback(CollectionChangeCallback fn, uint64_t token, std::chrono::milliseconds min_delivery_interval,
+                 KeyPathArray key_path_array, uint64_t owner)
+        : fn(std::move(fn)), token(token), min_delivery_interval(min_delivery_interval)
+        , key_path_array(std::move(key_path_array)), owner(owner) { }
+
         CollectionChangeCallback fn;
+        const uint64_t token;
+        const std::chrono::milliseconds min_delivery_interval;
+        const KeyPathArray key_path_array;
+        const uint64_t owner;
+
+        // Set on the target thread by suppress_next_notification() and
+        // cleared by add_changes() on the worker thread
+        std::atomic<bool> skip_next{false};
+        // Set by remove_callback() so that a callback which is removed while
+        // a list containing it is being delivered to isn't called
+        std::atomic<bool> removed{false};
+
+        // The index in m_key_path_filters of this callback's filter, or npos
+        // if it is sent m_change. Only used on the worker thread.
+        size_t key_path_filter_index = -1;
+
+        // Written by add_changes() and package_for_delivery(), which are both
+        // only called with RealmCoordinator::m_notifier_mutex locked
         CollectionChangeBuilder accumulated_changes;
+
+        // Only used on the target thread
         CollectionChangeSet changes_to_deliver;
-        uint64_t token;
-        bool initial_delivered;
-        bool skip_next;
+        bool initial_delivered = false;
+        // Changes are held back in accumulated_changes until this time
+        Clock::time_point next_delivery;
     };
+    using CallbackList = std::vector<std::shared_ptr<Callback>>;
 
-    // Currently registered callbacks and a mutex which must always be held
-    // while doing anything with them or m_callback_index
+    // The currently registered callbacks. A published list is never modified:
+    // add_callback() and remove_callback() publish a modified copy while
+    // holding m_callback_mutex, and everything else reads whichever list is
+    // current without locking, so removing a callback from another thread
+    // never has to wait for the worker or target thread to finish with it.
     util::CheckedMutex m_callback_mutex;
-    std::vector<Callback> m_callbacks;
+    util::AtomicSharedPtr<const CallbackList> m_callbacks{std::make_shared<CallbackList>()};
 
-    // Cached value for if m_callbacks is empty, needed to avoid deadlocks in
-    // run() due to lock-order inversion between m_callback_mutex and m_target_mutex
-    // It's okay if this value is stale as at worst it'll result in us doing
-    // some extra work.
+    // Cached value for if m_callbacks is empty, for use in run() and by the
+    // collections. It's okay if this value is stale as at worst it'll result
+    // in us doing some extra work.
     std::atomic<bool> m_have_callbacks = {false};
 
-    // Iteration variable for looping over callbacks
-    // remove_callback() updates this when needed
+    // The callbacks which were present when the notifier was packaged for
+    // delivery. Delivery iterates over this rather than m_callbacks so that
+    // callbacks registered during delivery aren't called until the next one.
+    // Released once delivery is complete so that it doesn't keep callbacks
+    // which were removed since alive. Only used on the target thread.
+    std::shared_ptr<const CallbackList> m_delivery_callbacks;
+    // Iteration variable for looping over m_delivery_callbacks, shared by
+    // reentrant calls to for_each_callback(). Only used on the target thread.
     size_t m_callback_index = -1;
-    // The number of callbacks which were present when the notifier was packaged
-    // for delivery which are still present.
-    // Updated by packaged_for_delivery and removd_callback(), and used in
-    // for_each_callback() to avoid calling callbacks registered during delivery.
-    size_t m_callback_count = -1;
 
     uint64_t m_next_token = 0;
+    uint64_t m_last_owner_id = 0;
+
+    // The time at which the coordinator was last asked to wake up the Realm
+    // to deliver held back changes. Only used on the target thread.
+    Clock::time_point m_scheduled_delivery;
 
     template<typename Fn>
-    void for_each_callback(Fn&& fn) REQUIRES(!m_callback_mutex);
+    void for_each_callback(Fn&& fn);
 
-    std::vector<Callback>::iterator find_callback(uint64_t token);
+    std::shared_ptr<Callback> find_callback(uint64_t token) const;
+    void remove_owner_callbacks(uint64_t owner) REQUIRES(!m_callback_mutex);
+    void update_key_path_filter();
+    void apply_key_path_filter();
+    std::vector<DeepChangeChecker::RelatedTable> related_tables_for(KeyPathArray const&) const;
 };
 
+template<typename Fn>
+auto CollectionNotifier::with_modification_checker(TransactionChangeInfo const& info,
+                                                   ConstTableRef root_table, size_t row_count, Fn&& fn)
+{
+    if (info.schema_changed)
+        set_table(root_table);
+    return with_modification_checker(info, root_table, row_count, m_related_tables, std::forward<Fn>(fn));
+}
+
+template<typename Fn>
+auto CollectionNotifier::with_modification_checker(TransactionChangeInfo const& info, ConstTableRef root_table,
+                                                   size_t row_count,
+                                                   std::vector<DeepChangeChecker::RelatedTable> const& related_tables,
+                                                   Fn&& fn)
+{
+    // First check if any of the tables accessible from the root table were
+    // actually modified. This can be false if there were only insertions, or
+    // deletions which were not linked to by any row in the linking table
+    auto table_modified = [&](auto& tbl) {
+        auto it = info.tables.find(tbl.table_key.value);
+        return it != info.tables.end() && !it->second.modifications_empty();
+    };
+    if (!std::any_of(begin(related_tables), end(related_tables), table_modified)) {
+        NoChangesChecker checker;
+        return fn(checker);
+    }
+    if (related_tables.size() == 1) {
+        TableChangeChecker checker(info.tables.find(related_tables[0].table_key.value)->second,
+                                   related_tables[0].columns);
+        return fn(checker);
+    }
+
+    DeepChangeChecker checker(info, *root_table, related_tables, row_count, m_max_link_depth);
+    return fn(checker);
+}
+
+template<typename KeyAt>
+void CollectionNotifier::calculate_filtered_changes(TransactionChangeInfo const& info, ConstTableRef root_table,
+                                                    size_t row_count, KeyAt&& key_at)
+{
+    for (auto& filter : m_key_path_filters) {
+        filter.change = m_change;
+        if (m_change.modifications.empty())
+            continue;
+        auto& modifications = filter.change->modifications;
+        modifications.clear();
+        with_modification_checker(info, root_table, row_count, filter.related_tables, [&](auto& checker) {
+            for (auto index : m_change.modifications.as_indexes()) {
+                if (checker(key_at(index)))
+                    modifications.add(index);
+            }
+            return true;
+        });
+    }
+}
+
 // A smart pointer to a CollectionNotifier that unregisters the notifier when
 // the pointer is destroyed. Movable. Copying will produce a null Handle.
 template <typename T>
@@ -274,6 +606,8 @@ public:
     {
         reset();
         std::shared_ptr<T>::operator=(std::move(other));
+        m_owner = other.m_owner;
+        other.m_owner = 0;
         return *this;
     }
 
@@ -285,13 +619,30 @@ public:
         return *this;
     }
 
+    // Add a callback which is removed when this handle is reset, even if the
+    // notifier is shared with another collection and so outlives the handle
+    uint64_t add_callback(CollectionChangeCallback callback, std::chrono::milliseconds min_delivery_interval={},
+                          KeyPathArray key_path_array={})
+    {
+        if (!m_owner)
+            m_owner = this->get()->new_owner_id();
+        return this->get()->add_callback(std::move(callback), min_delivery_interval, std::move(key_path_array),
+                                         m_owner);
+    }
+
     void reset()
     {
         if (*this) {
-            this->get()->unregister();
+            this->get()->unregister(m_owner);
             std::shared_ptr<T>::reset();
         }
+        m_owner = 0;
     }
+
+private:
+    // The id the callbacks added through this handle are tagged with, or zero
+    // if none have been added
+    uint64_t m_owner = 0;
 };
 
 // A package of CollectionNotifiers for a single Realm instance which is passed
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/delivery_timer.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+DeliveryTimer& DeliveryTimer::shared()
+{
+    static DeliveryTimer timer;
+    return timer;
+}
+
+DeliveryTimer::~DeliveryTimer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void DeliveryTimer::schedule(Clock::time_point time, std::function<void()> fn)
+{
+    bool is_earliest;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_thread.joinable())
+            m_thread = std::thread([this] { work(); });
+        auto it = m_pending.emplace(time, std::move(fn));
+        is_earliest = it == m_pending.begin();
+    }
+    // The thread only needs to wake up early if it's waiting for something
+    // later than the new time
+    if (is_earliest)
+        m_cv.notify_one();
+}
+
+void DeliveryTimer::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (m_pending.empty()) {
+            m_cv.wait(lock);
+            continue;
+        }
+
+        auto it = m_pending.begin();
+        if (Clock::now() < it->first) {
+            m_cv.wait_until(lock, it->first);
+            continue;
+        }
+
+        auto fn = std::move(it->second);
+        m_pending.erase(it);
+        lock.unlock();
+        fn();
+        // Release anything captured by the function without holding the lock
+        fn = nullptr;
+        lock.lock();
+    }
+}
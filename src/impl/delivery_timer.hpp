@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_DELIVERY_TIMER_HPP
+#define REALM_DELIVERY_TIMER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace realm {
+namespace _impl {
+
+// A single process-wide thread which calls functions at a requested time.
+// Used to wake up Realms which have notifications that were held back by a
+// callback's minimum delivery interval, as otherwise they would not be
+// delivered until something else triggered a notification.
+//
+// The functions are called on the timer's thread and should do nothing more
+// than signal some other thread to do the actual work.
+class DeliveryTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static DeliveryTimer& shared();
+
+    DeliveryTimer() = default;
+    ~DeliveryTimer();
+
+    DeliveryTimer(DeliveryTimer const&) = delete;
+    DeliveryTimer& operator=(DeliveryTimer const&) = delete;
+
+    // Call `fn` on the timer's thread once `time` has passed. The thread is
+    // started the first time this is called.
+    void schedule(Clock::time_point time, std::function<void()> fn);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::multimap<Clock::time_point, std::function<void()>> m_pending;
+    std::thread m_thread;
+    bool m_stopping = false;
+
+    void work();
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_DELIVERY_TIMER_HPP
@@ -37,7 +37,7 @@ ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
     while (m_sg.wait_for_change()) {
         m_sg.end_read();
         m_sg.begin_read();
-        m_parent.on_change();
+        m_parent.on_external_change();
     }
 }))
 {
@@ -86,19 +86,31 @@ void ListNotifier::run()
 
     if (m_type == PropertyType::Object) {
         auto& list = static_cast<LnkLst&>(*m_list);
-        auto object_did_change = get_modification_checker(*m_info, list.get_target_table());
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (m_change.modifications.contains(i))
-                continue;
-            if (object_did_change(list.get(i).value))
-                m_change.modifications.add(i);
-        }
+        auto add_modifications = [&](CollectionChangeBuilder& change, auto& object_did_change) {
+            for (size_t i = 0; i < list.size(); ++i) {
+                if (change.modifications.contains(i))
+                    continue;
+                if (object_did_change(list.get(i).value))
+                    change.modifications.add(i);
+            }
+
+            for (auto const& move : change.moves) {
+                if (change.modifications.contains(move.to))
+                    continue;
+                if (object_did_change(list.get(move.to).value))
+                    change.modifications.add(move.to);
+            }
+            return true;
+        };
 
-        for (auto const& move : m_change.moves) {
-            if (m_change.modifications.contains(move.to))
-                continue;
-            if (object_did_change(list.get(move.to).value))
-                m_change.modifications.add(move.to);
+        auto object_did_change = get_modification_checker(*m_info, list.get_target_table(), list.size());
+        // Changes to the list itself are reported to every callback, so each
+        // key path filter starts from those and then checks the objects
+        for (auto& filter : key_path_filters()) {
+            filter.change = m_change;
+            with_modification_checker(*m_info, list.get_target_table(), list.size(), filter.related_tables,
+                                      [&](auto& checker) { return add_modifications(*filter.change, checker); });
         }
+        add_modifications(m_change, object_did_change);
     }
 }
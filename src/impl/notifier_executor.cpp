@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/notifier_executor.hpp"
+
+#include "impl/realm_coordinator.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+NotifierExecutor& NotifierExecutor::shared()
+{
+    static NotifierExecutor executor;
+    return executor;
+}
+
+NotifierExecutor::~NotifierExecutor()
+{
+    stop_threads();
+}
+
+void NotifierExecutor::set_thread_count(size_t thread_count)
+{
+    std::lock_guard<std::mutex> config_lock(m_config_mutex);
+    stop_threads();
+
+    std::deque<std::weak_ptr<RealmCoordinator>> queue;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_thread_count = thread_count;
+        if (thread_count == 0) {
+            queue = std::move(m_queue);
+            m_queue.clear();
+            m_state.clear();
+        }
+        for (size_t i = 0; i < thread_count; ++i)
+            m_threads.emplace_back([this] { work(); });
+    }
+    m_cv.notify_all();
+
+    // Anything which was waiting to be run when the executor was disabled
+    // still needs to be run, and there's no longer anywhere else to run it
+    for (auto& weak_coordinator : queue) {
+        if (auto coordinator = weak_coordinator.lock())
+            coordinator->on_change();
+    }
+}
+
+size_t NotifierExecutor::thread_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_thread_count;
+}
+
+bool NotifierExecutor::submit(std::weak_ptr<RealmCoordinator> coordinator)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_thread_count == 0)
+            return false;
+
+        auto it = m_state.find(coordinator);
+        if (it != m_state.end()) {
+            // If it's already queued then it'll see this change when it runs,
+            // and if it's currently running we don't know if it will, so it
+            // needs to run again once it's done
+            if (it->second == State::Running)
+                it->second = State::Dirty;
+            return true;
+        }
+
+        m_state.emplace(coordinator, State::Queued);
+        m_queue.push_back(std::move(coordinator));
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+void NotifierExecutor::stop_threads()
+{
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        threads = std::move(m_threads);
+        m_threads.clear();
+    }
+    m_cv.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = false;
+}
+
+void NotifierExecutor::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+            return;
+
+        auto weak_coordinator = std::move(m_queue.front());
+        m_queue.pop_front();
+        auto coordinator = weak_coordinator.lock();
+        if (!coordinator) {
+            m_state.erase(weak_coordinator);
+            continue;
+        }
+        m_state[weak_coordinator] = State::Running;
+        lock.unlock();
+
+        coordinator->on_change();
+        // This may be the last reference to the coordinator, and destroying
+        // it can block on things which may need our lock
+        coordinator.reset();
+
+        lock.lock();
+        auto it = m_state.find(weak_coordinator);
+        REALM_ASSERT(it != m_state.end());
+        if (it->second == State::Dirty) {
+            // Go to the back of the queue so that other coordinators get a
+            // turn before this one runs again
+            it->second = State::Queued;
+            m_queue.push_back(std::move(weak_coordinator));
+        }
+        else {
+            m_state.erase(it);
+        }
+    }
+}
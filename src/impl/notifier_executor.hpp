@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_NOTIFIER_EXECUTOR_HPP
+#define REALM_NOTIFIER_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+class RealmCoordinator;
+
+// A process-wide pool of threads which runs RealmCoordinator::on_change() for
+// every coordinator, rather than running it on the thread of each
+// coordinator's ExternalCommitHelper. This bounds the number of threads doing
+// notifier work in processes which have many Realm files open at once. It does
+// not replace the ExternalCommitHelpers themselves: each file still needs its
+// own commit notification pipe to observe commits made by other processes, and
+// only observing those commits (not running notifiers) happens there.
+//
+// Coordinators are serviced in FIFO order and each coordinator is queued at
+// most once: a coordinator which receives more commits while it is being run
+// is moved to the back of the queue rather than being run again immediately,
+// so a single frequently-written file cannot starve the others.
+class NotifierExecutor {
+public:
+    // The executor used for all coordinators in the process
+    static NotifierExecutor& shared();
+
+    NotifierExecutor() = default;
+    ~NotifierExecutor();
+
+    NotifierExecutor(NotifierExecutor const&) = delete;
+    NotifierExecutor& operator=(NotifierExecutor const&) = delete;
+
+    // Set the number of threads used to run notifiers. Zero (the default)
+    // disables the executor, and each coordinator then runs its notifiers on
+    // the thread which observed the commit. Intended to be called once at
+    // startup; if called while work is pending, the current threads finish
+    // their current work first, and if the executor is being disabled any
+    // queued work is run on the calling thread.
+    void set_thread_count(size_t thread_count);
+    size_t thread_count() const;
+
+    // Schedule on_change() to be called for the coordinator on one of the
+    // executor's threads. Returns false without doing anything if the
+    // executor is disabled, in which case the caller should run it directly.
+    bool submit(std::weak_ptr<RealmCoordinator> coordinator);
+
+private:
+    enum class State {
+        // In m_queue waiting to be run
+        Queued,
+        // Currently being run on one of the threads
+        Running,
+        // Currently being run, and another run was requested while it was
+        Dirty,
+    };
+
+    std::mutex m_config_mutex;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::weak_ptr<RealmCoordinator>> m_queue;
+    std::map<std::weak_ptr<RealmCoordinator>, State, std::owner_less<std::weak_ptr<RealmCoordinator>>> m_state;
+    std::vector<std::thread> m_threads;
+    size_t m_thread_count = 0;
+    bool m_stopping = false;
+
+    void stop_threads();
+    void work();
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_NOTIFIER_EXECUTOR_HPP
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/notifier_statistics.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+void store_max(std::atomic<uint64_t>& target, uint64_t value) noexcept
+{
+    auto current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+} // anonymous namespace
+
+constexpr size_t LatencyHistogram::bucket_count;
+
+void LatencyHistogram::record(Clock::duration duration) noexcept
+{
+    auto us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+
+    size_t bucket = 0;
+    for (auto remaining = us; remaining && bucket + 1 < bucket_count; remaining >>= 1)
+        ++bucket;
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_total_us.fetch_add(us, std::memory_order_relaxed);
+    store_max(m_max_us, us);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const noexcept
+{
+    Snapshot ret;
+    ret.count = m_count.load(std::memory_order_relaxed);
+    ret.total = std::chrono::microseconds(m_total_us.load(std::memory_order_relaxed));
+    ret.max = std::chrono::microseconds(m_max_us.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < bucket_count; ++i)
+        ret.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    return ret;
+}
+
+void NotifierStatistics::set_new_notifier_count(size_t count) noexcept
+{
+    new_notifiers.store(count, std::memory_order_relaxed);
+    store_max(max_new_notifiers, count);
+}
+
+NotifierStatistics::Snapshot NotifierStatistics::snapshot() const noexcept
+{
+    Snapshot ret;
+    ret.advance = advance.snapshot();
+    ret.run = run.snapshot();
+    ret.run_query = run_query.snapshot();
+    ret.calculate_changes = calculate_changes.snapshot();
+    ret.package_for_delivery = package_for_delivery.snapshot();
+    ret.before_advance = before_advance.snapshot();
+    ret.after_advance = after_advance.snapshot();
+    ret.new_notifiers = new_notifiers.load(std::memory_order_relaxed);
+    ret.max_new_notifiers = max_new_notifiers.load(std::memory_order_relaxed);
+    ret.change_info_cache_hits = change_info_cache_hits.load(std::memory_order_relaxed);
+    ret.change_info_cache_misses = change_info_cache_misses.load(std::memory_order_relaxed);
+    return ret;
+}
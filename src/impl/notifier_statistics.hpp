@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_NOTIFIER_STATISTICS_HPP
+#define REALM_NOTIFIER_STATISTICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace realm {
+namespace _impl {
+
+// A lock-free histogram of durations. Recording and reading are both cheap
+// enough to do on every call, and reading concurrently with recording gives
+// values which may be slightly inconsistent with each other but never torn.
+class LatencyHistogram {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Bucket 0 holds durations of less than 1µs, bucket i holds durations in
+    // [2^(i-1), 2^i) µs, and the final bucket also holds everything longer
+    // (i.e. 8 seconds and up)
+    static constexpr size_t bucket_count = 25;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        std::chrono::microseconds total{0};
+        std::chrono::microseconds max{0};
+        std::array<uint64_t, bucket_count> buckets{};
+    };
+
+    void record(Clock::duration duration) noexcept;
+    Snapshot snapshot() const noexcept;
+
+    // Records the time between being constructed and destroyed. Does nothing
+    // if constructed with a null histogram.
+    class Timer {
+    public:
+        explicit Timer(LatencyHistogram* histogram) noexcept
+        : m_histogram(histogram)
+        , m_start(histogram ? Clock::now() : Clock::time_point())
+        {
+        }
+        ~Timer()
+        {
+            if (m_histogram)
+                m_histogram->record(Clock::now() - m_start);
+        }
+
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+
+    private:
+        LatencyHistogram* m_histogram;
+        Clock::time_point m_start;
+    };
+
+private:
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_total_us{0};
+    std::atomic<uint64_t> m_max_us{0};
+    std::array<std::atomic<uint64_t>, bucket_count> m_buckets{};
+};
+
+// Timings for each stage of the process of calculating and delivering
+// notifications for a single RealmCoordinator, for diagnosing where the time
+// between a commit and the notifications for it being delivered goes.
+struct NotifierStatistics {
+    // transaction::advance() on the notifier thread with change info
+    // being gathered
+    LatencyHistogram advance;
+    // Each call to CollectionNotifier::run()
+    LatencyHistogram run;
+    // The part of run() spent running queries and sorting results
+    LatencyHistogram run_query;
+    // The part of run() spent calculating the changes to the results
+    LatencyHistogram calculate_changes;
+    // Each call to CollectionNotifier::package_for_delivery(), before_advance()
+    // and after_advance() on the target thread, which includes the time spent
+    // in the user's callbacks
+    LatencyHistogram package_for_delivery;
+    LatencyHistogram before_advance;
+    LatencyHistogram after_advance;
+
+    // The number of notifiers which have been registered but not yet run for
+    // the first time, and the highest that number has ever been
+    std::atomic<uint64_t> new_notifiers{0};
+    std::atomic<uint64_t> max_new_notifiers{0};
+
+    // The number of advances which used changes from the ChangeInfoCache,
+    // and the number which had to parse the transaction logs to add them
+    std::atomic<uint64_t> change_info_cache_hits{0};
+    std::atomic<uint64_t> change_info_cache_misses{0};
+
+    struct Snapshot {
+        LatencyHistogram::Snapshot advance;
+        LatencyHistogram::Snapshot run;
+        LatencyHistogram::Snapshot run_query;
+        LatencyHistogram::Snapshot calculate_changes;
+        LatencyHistogram::Snapshot package_for_delivery;
+        LatencyHistogram::Snapshot before_advance;
+        LatencyHistogram::Snapshot after_advance;
+        uint64_t new_notifiers = 0;
+        uint64_t max_new_notifiers = 0;
+        uint64_t change_info_cache_hits = 0;
+        uint64_t change_info_cache_misses = 0;
+    };
+
+    void set_new_notifier_count(size_t count) noexcept;
+    Snapshot snapshot() const noexcept;
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_NOTIFIER_STATISTICS_HPP
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/notifier_worker_pool.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+NotifierWorkerPool::NotifierWorkerPool(size_t thread_count)
+{
+    m_threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_threads.emplace_back([this] {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                m_work_cv.wait(lock, [&] { return m_stopping || (m_fn && m_next < m_count); });
+                if (m_stopping)
+                    return;
+                work(lock);
+            }
+        });
+    }
+}
+
+NotifierWorkerPool::~NotifierWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void NotifierWorkerPool::run(size_t count, std::function<void(size_t)> const& fn)
+{
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_fn = &fn;
+    m_next = 0;
+    m_count = count;
+    m_work_cv.notify_all();
+
+    // The calling thread processes work too rather than just sitting idle
+    work(lock);
+    m_done_cv.wait(lock, [&] { return m_next == m_count && m_active == 0; });
+
+    m_fn = nullptr;
+    auto error = std::move(m_error);
+    m_error = nullptr;
+    lock.unlock();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void NotifierWorkerPool::work(std::unique_lock<std::mutex>& lock)
+{
+    while (m_fn && m_next < m_count) {
+        auto& fn = *m_fn;
+        size_t index = m_next++;
+        ++m_active;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            fn(index);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !m_error)
+            m_error = error;
+        --m_active;
+    }
+    if (m_active == 0)
+        m_done_cv.notify_all();
+}
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_NOTIFIER_WORKER_POOL_HPP
+#define REALM_NOTIFIER_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+
+// A fixed-size pool of threads used by RealmCoordinator to run independent
+// groups of notifiers in parallel. Work is submitted in fork-join style: run()
+// hands out the indices [0, count) to the pool's threads and to the calling
+// thread, and returns once all of them have been processed.
+class NotifierWorkerPool {
+public:
+    // Create a pool with `thread_count` threads in addition to the thread
+    // which calls run()
+    NotifierWorkerPool(size_t thread_count);
+    ~NotifierWorkerPool();
+
+    NotifierWorkerPool(NotifierWorkerPool const&) = delete;
+    NotifierWorkerPool& operator=(NotifierWorkerPool const&) = delete;
+
+    // Call `fn` once for each index in [0, count), blocking until all calls
+    // have completed. If any of the calls throw, the first exception thrown is
+    // rethrown after all calls have completed. Calls to run() from multiple
+    // threads are serialized.
+    void run(size_t count, std::function<void(size_t)> const& fn);
+
+    // The number of threads which run() uses, including the calling thread
+    size_t thread_count() const noexcept { return m_threads.size() + 1; }
+
+private:
+    std::mutex m_run_mutex;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::vector<std::thread> m_threads;
+
+    // State for the batch currently being run, if any
+    std::function<void(size_t)> const* m_fn = nullptr;
+    size_t m_next = 0;
+    size_t m_count = 0;
+    size_t m_active = 0;
+    std::exception_ptr m_error;
+
+    bool m_stopping = false;
+
+    void work(std::unique_lock<std::mutex>& lock);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_NOTIFIER_WORKER_POOL_HPP
@@ -0,0 +1,290 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_OBJECT_KEY_TABLE_HPP
+#define REALM_OBJECT_KEY_TABLE_HPP
+
+#include "index_set.hpp"
+
+#include <realm/util/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+// A key and value stored in an ObjectKeyTable used as a map. Named the same
+// as std::pair's members so that it can be iterated over like a std::map.
+template<typename Value>
+struct ObjectKeyEntry {
+    int64_t first;
+    Value second;
+};
+
+inline int64_t& object_key_of(int64_t& slot) noexcept { return slot; }
+inline int64_t object_key_of(int64_t const& slot) noexcept { return slot; }
+template<typename Value>
+int64_t& object_key_of(ObjectKeyEntry<Value>& slot) noexcept { return slot.first; }
+template<typename Value>
+int64_t object_key_of(ObjectKeyEntry<Value> const& slot) noexcept { return slot.first; }
+
+// A hash set (with a Slot of int64_t) or map (with a Slot of ObjectKeyEntry)
+// of object keys. All of the entries are stored in a single array using open
+// addressing with linear probing, so a set of a million keys is one
+// allocation rather than a million separate nodes, and erasing uses backward
+// shifting so that there are never any tombstones to skip over. The array is
+// allocated from the current ChunkArena, if any, in the same way as the
+// chunks of an IndexSet.
+template<typename Slot>
+class ObjectKeyTable {
+public:
+    // The key used to mark unused slots. Object keys are either non-negative
+    // or small negative numbers for unresolved objects, so this is never a
+    // valid key.
+    static constexpr int64_t empty_key = std::numeric_limits<int64_t>::min();
+
+    ObjectKeyTable() = default;
+    ObjectKeyTable(ObjectKeyTable const&) = default;
+    ObjectKeyTable& operator=(ObjectKeyTable const&) = default;
+    ObjectKeyTable(ObjectKeyTable&& other) noexcept
+    : m_slots(std::move(other.m_slots)), m_size(other.m_size)
+    {
+        other.m_slots.clear();
+        other.m_size = 0;
+    }
+    ObjectKeyTable& operator=(ObjectKeyTable&& other) noexcept
+    {
+        m_slots = std::move(other.m_slots);
+        m_size = other.m_size;
+        other.m_slots.clear();
+        other.m_size = 0;
+        return *this;
+    }
+
+    bool empty() const noexcept { return m_size == 0; }
+    size_t size() const noexcept { return m_size; }
+
+    bool contains(int64_t key) const noexcept { return find(key) != nullptr; }
+    size_t count(int64_t key) const noexcept { return contains(key); }
+
+    // Returns nullptr if the key is not present
+    Slot const* find(int64_t key) const noexcept;
+    Slot* find(int64_t key) noexcept
+    {
+        return const_cast<Slot*>(static_cast<ObjectKeyTable const&>(*this).find(key));
+    }
+
+    // Returns the slot for the key and whether it was newly added. Slots
+    // which are added have a value-initialized value. The pointer is
+    // invalidated by the next insertion or erasure.
+    std::pair<Slot*, bool> insert(int64_t key);
+    // Returns whether or not the key was present
+    bool erase(int64_t key) noexcept;
+    void clear() noexcept;
+
+    // Make room for `count` keys without needing to rehash
+    void reserve(size_t count);
+
+    // The number of bytes of heap memory used by the table
+    size_t memory_usage() const noexcept { return m_slots.capacity() * sizeof(Slot); }
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Slot;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Slot const*;
+        using reference = Slot const&;
+
+        const_iterator(Slot const* pos, Slot const* end) noexcept : m_pos(pos), m_end(end) { skip_empty(); }
+
+        reference operator*() const noexcept { return *m_pos; }
+        pointer operator->() const noexcept { return m_pos; }
+        bool operator==(const_iterator const& other) const noexcept { return m_pos == other.m_pos; }
+        bool operator!=(const_iterator const& other) const noexcept { return m_pos != other.m_pos; }
+
+        const_iterator& operator++() noexcept
+        {
+            ++m_pos;
+            skip_empty();
+            return *this;
+        }
+        const_iterator operator++(int) noexcept
+        {
+            auto value = *this;
+            ++*this;
+            return value;
+        }
+
+    private:
+        Slot const* m_pos;
+        Slot const* m_end;
+
+        void skip_empty() noexcept
+        {
+            while (m_pos != m_end && object_key_of(*m_pos) == empty_key)
+                ++m_pos;
+        }
+    };
+    using iterator = const_iterator;
+
+    const_iterator begin() const noexcept { return {m_slots.data(), m_slots.data() + m_slots.size()}; }
+    const_iterator end() const noexcept { return {m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()}; }
+
+private:
+    // The number of slots is always zero or a power of two, and is kept at
+    // least a third larger than the number of keys
+    std::vector<Slot, ChunkAllocator<Slot>> m_slots;
+    size_t m_size = 0;
+
+    static Slot empty_slot() noexcept
+    {
+        Slot slot{};
+        object_key_of(slot) = empty_key;
+        return slot;
+    }
+
+    size_t ideal_position(int64_t key) const noexcept
+    {
+        // Object keys are usually allocated sequentially, and are then
+        // frequently looked up in order, so runs of 16 consecutive keys are
+        // kept in adjacent slots and only the runs themselves are scattered
+        // around the table. The high bits of the product are mixed in so
+        // that keys which differ only in their high bits don't collide.
+        uint64_t hash = (uint64_t(key) >> 4) * 0x9E3779B97F4A7C15ULL;
+        hash = ((hash ^ (hash >> 29)) << 4) | (uint64_t(key) & 15);
+        return size_t(hash) & (m_slots.size() - 1);
+    }
+
+    void rehash(size_t slot_count);
+};
+
+template<typename Slot>
+constexpr int64_t ObjectKeyTable<Slot>::empty_key;
+
+template<typename Slot>
+Slot const* ObjectKeyTable<Slot>::find(int64_t key) const noexcept
+{
+    if (m_size == 0)
+        return nullptr;
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = ideal_position(key); ; i = (i + 1) & mask) {
+        int64_t k = object_key_of(m_slots[i]);
+        if (k == key)
+            return &m_slots[i];
+        if (k == empty_key)
+            return nullptr;
+    }
+}
+
+template<typename Slot>
+std::pair<Slot*, bool> ObjectKeyTable<Slot>::insert(int64_t key)
+{
+    REALM_ASSERT_DEBUG(key != empty_key);
+    if ((m_size + 1) * 4 > m_slots.size() * 3)
+        rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = ideal_position(key); ; i = (i + 1) & mask) {
+        auto& slot = m_slots[i];
+        int64_t k = object_key_of(slot);
+        if (k == key)
+            return {&slot, false};
+        if (k == empty_key) {
+            object_key_of(slot) = key;
+            ++m_size;
+            return {&slot, true};
+        }
+    }
+}
+
+template<typename Slot>
+bool ObjectKeyTable<Slot>::erase(int64_t key) noexcept
+{
+    auto slot = find(key);
+    if (!slot)
+        return false;
+
+    // Move back any following keys in the same probe sequence which would no
+    // longer be reachable once there's an empty slot at `hole`
+    size_t mask = m_slots.size() - 1;
+    size_t hole = slot - m_slots.data();
+    for (size_t i = (hole + 1) & mask; object_key_of(m_slots[i]) != empty_key; i = (i + 1) & mask) {
+        size_t ideal = ideal_position(object_key_of(m_slots[i]));
+        // The key can move to the hole if the hole is cyclically between its
+        // ideal position and its current position
+        if (((i - ideal) & mask) >= ((i - hole) & mask)) {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole] = empty_slot();
+    --m_size;
+    return true;
+}
+
+template<typename Slot>
+void ObjectKeyTable<Slot>::clear() noexcept
+{
+    if (m_size == 0)
+        return;
+    std::fill(m_slots.begin(), m_slots.end(), empty_slot());
+    m_size = 0;
+}
+
+template<typename Slot>
+void ObjectKeyTable<Slot>::reserve(size_t count)
+{
+    size_t slot_count = m_slots.empty() ? 16 : m_slots.size();
+    while (count * 4 > slot_count * 3)
+        slot_count *= 2;
+    if (slot_count != m_slots.size())
+        rehash(slot_count);
+}
+
+template<typename Slot>
+void ObjectKeyTable<Slot>::rehash(size_t slot_count)
+{
+    // Keep using the allocator the table was created with even if a
+    // different arena is current now
+    decltype(m_slots) old_slots(slot_count, empty_slot(), m_slots.get_allocator());
+    m_slots.swap(old_slots);
+
+    size_t mask = slot_count - 1;
+    for (auto& slot : old_slots) {
+        if (object_key_of(slot) == empty_key)
+            continue;
+        size_t i = ideal_position(object_key_of(slot));
+        while (object_key_of(m_slots[i]) != empty_key)
+            i = (i + 1) & mask;
+        m_slots[i] = slot;
+    }
+}
+
+using ObjectKeySet = ObjectKeyTable<int64_t>;
+template<typename Value>
+using ObjectKeyMap = ObjectKeyTable<ObjectKeyEntry<Value>>;
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_OBJECT_KEY_TABLE_HPP
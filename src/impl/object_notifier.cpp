@@ -20,21 +20,38 @@
 
 #include "shared_realm.hpp"
 
+#include <realm/db.hpp>
+
 using namespace realm;
 using namespace realm::_impl;
 
-ObjectNotifier::ObjectNotifier(std::shared_ptr<Realm> realm, TableKey table, ObjKey obj)
+ObjectNotifier::ObjectNotifier(std::shared_ptr<Realm> realm, ConstTableRef table, ObjKey obj)
 : CollectionNotifier(std::move(realm))
-, m_table(table)
+, m_table(table->get_key())
 , m_obj(obj)
 {
+    set_table(table);
+}
+
+void ObjectNotifier::do_attach_to(Transaction& sg)
+{
+    if (m_table)
+        m_source_table = sg.get_table(m_table);
+}
+
+void ObjectNotifier::release_data() noexcept
+{
+    m_source_table = {};
+    CollectionNotifier::release_data();
 }
 
 bool ObjectNotifier::do_add_required_change_info(TransactionChangeInfo& info)
 {
     m_info = &info;
     info.tables[m_table.value];
-    return false;
+    // Only the object's own table is needed unless a key path filter follows
+    // links out of it
+    return has_key_path_filter() || !key_path_filters().empty();
 }
 
 void ObjectNotifier::run()
@@ -51,14 +68,63 @@ void ObjectNotifier::run()
         m_change.deletions.add(0);
         m_table = {};
         m_obj = {};
+        m_source_table = {};
         return;
     }
 
-    auto column_modifications = change.get_columns_modified(m_obj.value);
-    if (!column_modifications)
+    calculate_change(m_change, change, related_tables());
+    for (auto& filter : key_path_filters()) {
+        filter.change = CollectionChangeBuilder{};
+        calculate_change(*filter.change, change, filter.related_tables);
+    }
+}
+
+void ObjectNotifier::calculate_change(CollectionChangeBuilder& change, ObjectChangeSet const& table_changes,
+                                      std::vector<DeepChangeChecker::RelatedTable> const& related_tables)
+{
+    auto& filtered_columns = related_tables.front().columns;
+    if (auto column_modifications = table_changes.get_columns_modified(m_obj.value)) {
+        for (auto col : *column_modifications) {
+            if (filtered_columns.empty() || std::find(filtered_columns.begin(), filtered_columns.end(), col) != filtered_columns.end())
+                change.columns[col].add(0);
+        }
+        if (filtered_columns.empty() || !change.columns.empty())
+            change.modifications.add(0);
+    }
+
+    if (!filtered_columns.empty())
+        check_filtered_links(change, related_tables);
+}
+
+void ObjectNotifier::check_filtered_links(CollectionChangeBuilder& change,
+                                          std::vector<DeepChangeChecker::RelatedTable> const& related_tables)
+{
+    if (related_tables.front().links.empty() || max_link_depth() < 2)
         return;
-    m_change.modifications.add(0);
-    for (auto col : *column_modifications) {
-        m_change.columns[col].add(0);
+    auto& table = m_source_table;
+    if (!table || !table->is_valid(m_obj))
+        return;
+
+    // Check the objects linked to by each link column separately so that the
+    // change is reported for the column which leads to the modified object
+    ConstObj obj = table->get_object(m_obj);
+    for (auto& link : related_tables.front().links) {
+        if (change.columns.count(link.col_key))
+            continue;
+        ColKey col_key(link.col_key);
+        auto& target = *table->get_link_target(col_key);
+        DeepChangeChecker checker(*m_info, target, related_tables, 0, max_link_depth() - 1);
+        bool modified = false;
+        if (!link.is_list) {
+            modified = !obj.is_null(col_key) && checker(obj.get<ObjKey>(col_key).value);
+        }
+        else {
+            auto lvr = obj.get_linklist(col_key);
+            modified = std::any_of(lvr.begin(), lvr.end(), [&](auto key) { return checker(key.value); });
+        }
+        if (modified) {
+            change.modifications.add(0);
+            change.columns[link.col_key].add(0);
+        }
     }
 }
@@ -28,16 +28,28 @@ namespace realm {
 namespace _impl {
 class ObjectNotifier : public CollectionNotifier {
 public:
-    ObjectNotifier(std::shared_ptr<Realm> realm, TableKey table, ObjKey obj);
+    ObjectNotifier(std::shared_ptr<Realm> realm, ConstTableRef table, ObjKey obj);
 
 private:
     TableKey m_table;
     ObjKey m_obj;
     TransactionChangeInfo* m_info;
+    // The object's table in the notifier's own Transaction. Only used to
+    // follow the links in a key path filter.
+    ConstTableRef m_source_table;
 
     void run() override;
+    // Calculate the change to the object for the given key path filter
+    void calculate_change(CollectionChangeBuilder& change, ObjectChangeSet const& table_changes,
+                          std::vector<DeepChangeChecker::RelatedTable> const& related_tables);
+    // Mark each link column in the key path filter as modified if an object
+    // reachable through it was modified
+    void check_filtered_links(CollectionChangeBuilder& change,
+                              std::vector<DeepChangeChecker::RelatedTable> const& related_tables);
 
     bool do_add_required_change_info(TransactionChangeInfo& info) override;
+    void do_attach_to(Transaction& sg) override;
+    void release_data() noexcept override;
 };
 }
 }
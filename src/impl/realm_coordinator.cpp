@@ -18,8 +18,12 @@
 
 #include "impl/realm_coordinator.hpp"
 
+#include "impl/change_info_cache.hpp"
 #include "impl/collection_notifier.hpp"
+#include "impl/delivery_timer.hpp"
 #include "impl/external_commit_helper.hpp"
+#include "impl/notifier_executor.hpp"
+#include "impl/notifier_worker_pool.hpp"
 #include "impl/transact_log_handler.hpp"
 #include "impl/weak_realm_notifier.hpp"
 #include "binding_context.hpp"
@@ -64,6 +68,7 @@ std::shared_ptr<RealmCoordinator> RealmCoordinator::get_coordinator(StringData p
     }
 
     auto coordinator = std::make_shared<RealmCoordinator>();
+    coordinator->m_weak_self = coordinator;
     weak_coordinator = coordinator;
     return coordinator;
 }
@@ -492,6 +497,7 @@ void RealmCoordinator::close()
 {
     m_db->close();
     m_db = nullptr;
+    m_change_info_cache->clear();
 }
 
 std::shared_ptr<Group> RealmCoordinator::begin_read(VersionID version, bool frozen_transaction)
@@ -555,8 +561,9 @@ void RealmCoordinator::advance_schema_cache(uint64_t previous, uint64_t next)
 }
 
 RealmCoordinator::RealmCoordinator()
+: m_change_info_cache(std::make_unique<ChangeInfoCache>(m_notifier_statistics))
 #if REALM_ENABLE_SYNC
-: m_partial_sync_work_queue(std::make_unique<_impl::partial_sync::WorkQueue>())
+, m_partial_sync_work_queue(std::make_unique<_impl::partial_sync::WorkQueue>())
 #endif
 {
 }
@@ -736,15 +743,34 @@ void RealmCoordinator::pin_version(VersionID versionid)
 
 // Thread-safety analsys doesn't reasonably handle calling functions on different
 // instances of this type
-void RealmCoordinator::register_notifier(std::shared_ptr<CollectionNotifier> notifier) NO_THREAD_SAFETY_ANALYSIS
+std::shared_ptr<CollectionNotifier> RealmCoordinator::register_notifier(std::shared_ptr<CollectionNotifier> notifier) NO_THREAD_SAFETY_ANALYSIS
 {
     auto version = notifier->version();
-    auto& self = Realm::Internal::get_coordinator(*notifier->get_realm());
-    {
-        util::CheckedLockGuard lock(self.m_notifier_mutex);
-        self.pin_version(version);
-        self.m_new_notifiers.push_back(std::move(notifier));
-    }
+    auto& realm = *notifier->get_realm();
+    auto& self = Realm::Internal::get_coordinator(realm);
+    util::CheckedLockGuard lock(self.m_notifier_mutex);
+
+    // If there's an equivalent notifier for the same Realm then we can just
+    // reuse that one rather than running the same query and calculating the
+    // same changes twice
+    auto find_shareable = [&](auto& notifiers) -> std::shared_ptr<CollectionNotifier> {
+        for (auto& existing : notifiers) {
+            if (existing->can_share(*notifier) && existing->is_for_realm(realm) && existing->add_owner())
+                return existing;
+        }
+        return nullptr;
+    };
+    if (auto existing = find_shareable(self.m_new_notifiers))
+        return existing;
+    if (auto existing = find_shareable(self.m_notifiers))
+        return existing;
+
+    self.pin_version(version);
+    notifier->set_statistics(&self.m_notifier_statistics);
+    notifier->set_max_link_depth(self.m_config.max_notification_link_depth);
+    self.m_new_notifiers.push_back(notifier);
+    self.m_notifier_statistics.set_new_notifier_count(self.m_new_notifiers.size());
+    return notifier;
 }
 
 void RealmCoordinator::clean_up_dead_notifiers()
@@ -768,31 +794,82 @@ void RealmCoordinator::clean_up_dead_notifiers()
         return did_remove;
     };
 
-    if (swap_remove(m_notifiers) && m_notifiers.empty()) {
-        m_notifier_sg = nullptr;
-        m_notifier_skip_version = {0, 0};
+    if (swap_remove(m_notifiers)) {
+        if (m_notifiers.empty()) {
+            m_notifier_sg = nullptr;
+            m_latest_version_sg = nullptr;
+            m_notifier_worker_sgs.clear();
+            m_notifier_skip_version = {0, 0};
+        }
+        else if (!m_notifier_worker_sgs.empty()) {
+            // Release the transactions for any worker groups which no longer
+            // have any notifiers so that they don't pin old versions
+            std::vector<bool> in_use(m_notifier_worker_sgs.size() + 1);
+            for (auto& notifier : m_notifiers)
+                in_use[notifier->worker_index()] = true;
+            for (size_t i = 0; i < m_notifier_worker_sgs.size(); ++i) {
+                if (!in_use[i + 1])
+                    m_notifier_worker_sgs[i] = nullptr;
+            }
+        }
     }
-    if (swap_remove(m_new_notifiers) && m_new_notifiers.empty()) {
-        m_advancer_sg = nullptr;
+    if (swap_remove(m_new_notifiers)) {
+        m_notifier_statistics.set_new_notifier_count(m_new_notifiers.size());
+        if (m_new_notifiers.empty())
+            m_advancer_sg = nullptr;
     }
 }
 
 void RealmCoordinator::on_change()
 {
     run_async_notifiers();
+    notify_realms();
+}
 
+void RealmCoordinator::notify_realms()
+{
     util::CheckedLockGuard lock(m_realm_mutex);
     for (auto& realm : m_weak_realm_notifiers) {
         realm.notify();
     }
 }
 
+void RealmCoordinator::notify_realms_at(std::chrono::steady_clock::time_point time)
+{
+    std::weak_ptr<RealmCoordinator> weak_self;
+    try {
+        weak_self = shared_from_this();
+    }
+    catch (std::bad_weak_ptr const&) {
+        return;
+    }
+
+    DeliveryTimer::shared().schedule(time, [weak_self = std::move(weak_self)] {
+        if (auto self = weak_self.lock())
+            self->notify_realms();
+    });
+}
+
+void RealmCoordinator::on_external_change()
+{
+    // This must not take a strong reference to the coordinator: if that ended
+    // up being the last one, the coordinator would be destroyed on the thread
+    // which its ExternalCommitHelper has to deregister from or join. The
+    // executor only locks the weak pointer on its own threads.
+    if (!NotifierExecutor::shared().submit(m_weak_self))
+        on_change();
+}
+
 namespace {
 class IncrementalChangeInfo {
 public:
     IncrementalChangeInfo(Transaction& sg,
-                          std::vector<std::shared_ptr<_impl::CollectionNotifier>>& notifiers)
+                          std::vector<std::shared_ptr<_impl::CollectionNotifier>>& notifiers,
+                          ChangeInfoCache& cache,
+                          LatencyHistogram& advance_timings)
     : m_sg(sg)
+    , m_cache(cache)
+    , m_advance_timings(advance_timings)
     {
         if (notifiers.empty())
             return;
@@ -822,12 +899,9 @@ public:
     bool advance_incremental(VersionID version)
     {
         if (version != m_sg.get_version_of_current_transaction()) {
-            transaction::advance(m_sg, *m_current, version);
+            advance_current(version);
             m_info.push_back({std::move(m_current->lists)});
-            auto next = &m_info.back();
-            for (auto& table : m_current->tables)
-                next->tables[table.first];
-            m_current = next;
+            m_current = &m_info.back();
             return true;
         }
         return false;
@@ -840,26 +914,26 @@ public:
             return;
         }
 
-        transaction::advance(m_sg, *m_current, version);
+        advance_current(version);
 
         // We now need to combine the transaction change info objects so that all of
         // the notifiers see the complete set of changes from their first version to
-        // the most recent one
+        // the most recent one. Each table's changes only need to be passed back as
+        // far as the first version whose notifiers need that table, and can be
+        // moved rather than copied out of versions whose notifiers don't need it.
         for (size_t i = m_info.size() - 1; i > 0; --i) {
             auto& cur = m_info[i];
-            if (cur.tables.empty())
-                continue;
             auto& prev = m_info[i - 1];
-            if (prev.tables.empty()) {
-                prev.tables = cur.tables;
-                continue;
-            }
+            auto& needed_by_earlier = m_tables_needed[i - 1];
+            auto& needed_by_cur = m_own_tables_needed[i];
             for (auto& ct : cur.tables) {
+                if (ct.second.empty() || !std::binary_search(needed_by_earlier.begin(), needed_by_earlier.end(), ct.first))
+                    continue;
                 auto& pt = prev.tables[ct.first];
-                if (pt.empty())
-                    pt = ct.second;
+                if (std::binary_search(needed_by_cur.begin(), needed_by_cur.end(), ct.first))
+                    pt.merge(ct.second);
                 else
-                    pt.merge(ObjectChangeSet{ct.second});
+                    pt.merge(std::move(ct.second));
             }
         }
 
@@ -878,6 +952,59 @@ private:
     std::vector<TransactionChangeInfo> m_info;
     TransactionChangeInfo* m_current = nullptr;
     Transaction& m_sg;
+    ChangeInfoCache& m_cache;
+    LatencyHistogram& m_advance_timings;
+
+    // For each entry in m_info, the sorted keys of the tables which the
+    // notifiers using that entry need, and of the tables which the notifiers
+    // using that entry or any earlier one need
+    std::vector<std::vector<TableKeyType>> m_own_tables_needed;
+    std::vector<std::vector<TableKeyType>> m_tables_needed;
+
+    void advance_current(VersionID version)
+    {
+        // At this point the current info only has the tables which were added
+        // by its own notifiers. Parsing the transaction log removes tables with
+        // no changes, so the set of tables needed has to be captured first.
+        std::vector<TableKeyType> own;
+        own.reserve(m_current->tables.size());
+        for (auto& table : m_current->tables)
+            own.push_back(table.first);
+        std::sort(own.begin(), own.end());
+
+        // The changes to tables needed by earlier versions' notifiers have to
+        // be recorded too so that they can be passed back to those versions
+        std::vector<TableKeyType> all;
+        if (m_tables_needed.empty()) {
+            all = own;
+        }
+        else {
+            auto& earlier = m_tables_needed.back();
+            std::set_union(earlier.begin(), earlier.end(), own.begin(), own.end(), std::back_inserter(all));
+            for (auto key : earlier)
+                m_current->tables[key];
+        }
+        m_own_tables_needed.push_back(std::move(own));
+        m_tables_needed.push_back(std::move(all));
+
+        LatencyHistogram::Timer timer(&m_advance_timings);
+        m_cache.advance(m_sg, *m_current, version);
+    }
+};
+
+// A set of notifiers which are all attached to the same Transaction, and so
+// have to be run serially with respect to each other
+struct NotifierGroup {
+    std::shared_ptr<Transaction> sg;
+    std::vector<std::shared_ptr<_impl::CollectionNotifier>> notifiers;
+    std::vector<std::shared_ptr<_impl::CollectionNotifier>> new_notifiers;
+    // The per-table object changes gathered while advancing the group and the
+    // index sets for the changes calculated by its notifiers are allocated
+    // from here, and then all freed at once at the end of the run after the
+    // notifiers' changes are copied out by prepare_handover()
+    _impl::ChunkArena arena;
+
+    size_t size() const { return notifiers.size() + new_notifiers.size(); }
 };
 } // anonymous namespace
 
@@ -899,18 +1026,40 @@ void RealmCoordinator::run_async_notifiers()
     if (m_async_error) {
         std::move(m_new_notifiers.begin(), m_new_notifiers.end(), std::back_inserter(m_notifiers));
         m_new_notifiers.clear();
+        m_notifier_statistics.set_new_notifier_count(0);
         m_notifier_cv.notify_all();
         return;
     }
 
     VersionID version;
 
+    // m_config can be replaced with a different thread count when the file
+    // is reopened. Notifiers can't move between Transactions, so groups past
+    // the configured count are kept until their notifiers are gone, but new
+    // notifiers are only added to the configured groups.
+    size_t configured_group_count = std::max<size_t>(m_config.notifier_thread_count, 1);
+    size_t group_count = configured_group_count;
+    for (auto& notifier : m_notifiers)
+        group_count = std::max(group_count, notifier->worker_index() + 1);
+    m_notifier_worker_sgs.resize(group_count - 1);
+    if (group_count == 1)
+        m_notifier_worker_pool = nullptr;
+    else if (!m_notifier_worker_pool || m_notifier_worker_pool->thread_count() != group_count)
+        m_notifier_worker_pool = std::make_unique<NotifierWorkerPool>(group_count - 1);
+    m_change_info_cache->set_worker_group_count(group_count);
+
     // Advance all of the new notifiers to the most recent version, if any
     auto new_notifiers = std::move(m_new_notifiers);
-    IncrementalChangeInfo new_notifier_change_info(*m_advancer_sg, new_notifiers);
+    m_new_notifiers.clear();
+    m_notifier_statistics.set_new_notifier_count(0);
+    // The changes gathered while advancing the new notifiers are discarded
+    // at the end of the run along with the rest of the run's arenas
+    _impl::ChunkArena advancer_arena;
+    IncrementalChangeInfo new_notifier_change_info(*m_advancer_sg, new_notifiers, *m_change_info_cache, m_notifier_statistics.advance);
     auto advancer_sg = std::move(m_advancer_sg);
 
     if (!new_notifiers.empty()) {
+        _impl::ChunkArena::Scope arena_scope(advancer_arena);
         REALM_ASSERT(advancer_sg);
         REALM_ASSERT_3(advancer_sg->get_version_of_current_transaction().version,
                        <=, new_notifiers.front()->version().version);
@@ -945,68 +1094,135 @@ void RealmCoordinator::run_async_notifiers()
         // version, but we have to pick a "latest" version while holding the
         // notifier lock to avoid advancing over a transaction which should be
         // skipped
-        // FIXME: this is comically slow
-        version = m_db->start_read()->get_version_of_current_transaction();
+        version = get_latest_version_id();
     }
 
     auto skip_version = m_notifier_skip_version;
     m_notifier_skip_version = {0, 0};
 
+    // Split the notifiers into groups which each have their own Transaction so
+    // that they can be run in parallel. Existing notifiers stay in the group
+    // they were first attached in, and new ones go to the smallest group.
+    std::vector<NotifierGroup> groups(group_count);
+    for (auto& notifier : m_notifiers)
+        groups[notifier->worker_index()].notifiers.push_back(notifier);
+    for (auto& notifier : new_notifiers) {
+        auto group = std::min_element(groups.begin(), groups.begin() + configured_group_count,
+                                      [](auto& lft, auto& rgt) { return lft.size() < rgt.size(); });
+        notifier->set_worker_index(group - groups.begin());
+        group->new_notifiers.push_back(notifier);
+    }
+
+    // Every group's Transaction has to start out at the same version as the
+    // main one so that they all see the same changes
+    for (size_t i = 1; i < group_count; ++i) {
+        auto& sg = m_notifier_worker_sgs[i - 1];
+        if (!sg && groups[i].size())
+            sg = m_db->start_read(m_notifier_sg->get_version_of_current_transaction());
+        groups[i].sg = sg;
+    }
+    groups[0].sg = m_notifier_sg;
+    // The main group always needs to be advanced even if it has no notifiers,
+    // but the others can just be skipped if they're empty
+    groups.erase(std::remove_if(groups.begin() + 1, groups.end(), [](auto& group) { return !group.size(); }),
+                 groups.end());
+
     // Make a copy of the notifiers vector and then release the lock to avoid
     // blocking other threads trying to register or unregister notifiers while we run them
-    auto notifiers = m_notifiers;
+    bool have_existing_notifiers = !m_notifiers.empty();
     m_notifiers.insert(m_notifiers.end(), new_notifiers.begin(), new_notifiers.end());
     lock.unlock();
 
+    auto for_each_group = [&](std::function<void(NotifierGroup&)> fn) {
+        if (groups.size() > 1)
+            m_notifier_worker_pool->run(groups.size(), [&](size_t i) { fn(groups[i]); });
+        else
+            fn(groups.front());
+    };
+    // With only one group to run the pool would otherwise sit idle, so lend
+    // it to the notifiers to split up the work for very large collections
+    NotifierWorkerPool* idle_pool = groups.size() == 1 ? m_notifier_worker_pool.get() : nullptr;
+    auto run = [&](auto& notifier) {
+        LatencyHistogram::Timer timer(&m_notifier_statistics.run);
+        notifier->set_worker_pool(idle_pool);
+        notifier->run();
+        notifier->set_worker_pool(nullptr);
+    };
+
     if (skip_version.version) {
-        REALM_ASSERT(!notifiers.empty());
+        REALM_ASSERT(have_existing_notifiers);
         REALM_ASSERT(version >= skip_version);
-        IncrementalChangeInfo change_info(*m_notifier_sg, notifiers);
-        for (auto& notifier : notifiers)
-            notifier->add_required_change_info(change_info.current());
-        change_info.advance_to_final(skip_version);
+        for_each_group([&](NotifierGroup& group) {
+            _impl::ChunkArena::Scope arena_scope(group.arena);
+            IncrementalChangeInfo change_info(*group.sg, group.notifiers, *m_change_info_cache, m_notifier_statistics.advance);
+            for (auto& notifier : group.notifiers)
+                notifier->add_required_change_info(change_info.current());
+            change_info.advance_to_final(skip_version);
 
-        for (auto& notifier : notifiers)
-            notifier->run();
+            for (auto& notifier : group.notifiers)
+                run(notifier);
+        });
 
         util::CheckedLockGuard lock(m_notifier_mutex);
-        for (auto& notifier : notifiers)
-            notifier->prepare_handover();
+        for_each_group([&](NotifierGroup& group) {
+            for (auto& notifier : group.notifiers)
+                notifier->prepare_handover();
+        });
     }
 
-    // Advance the non-new notifiers to the same version as we advanced the new
-    // ones to (or the latest if there were no new ones)
-    IncrementalChangeInfo change_info(*m_notifier_sg, notifiers);
-    for (auto& notifier : notifiers) {
-        notifier->add_required_change_info(change_info.current());
-    }
-    change_info.advance_to_final(version);
+    for_each_group([&](NotifierGroup& group) {
+        _impl::ChunkArena::Scope arena_scope(group.arena);
 
-    // Attach the new notifiers to the main SG and move them to the main list
-    for (auto& notifier : new_notifiers) {
-        notifier->attach_to(m_notifier_sg);
-        notifier->run();
-    }
+        // Advance the non-new notifiers to the same version as we advanced the new
+        // ones to (or the latest if there were no new ones)
+        IncrementalChangeInfo change_info(*group.sg, group.notifiers, *m_change_info_cache, m_notifier_statistics.advance);
+        for (auto& notifier : group.notifiers) {
+            notifier->add_required_change_info(change_info.current());
+        }
+        change_info.advance_to_final(version);
 
-    // Change info is now all ready, so the notifiers can now perform their
-    // background work
-    for (auto& notifier : notifiers) {
-        notifier->run();
-    }
+        // Attach the new notifiers to the group's SG
+        for (auto& notifier : group.new_notifiers) {
+            notifier->attach_to(group.sg);
+            run(notifier);
+        }
+
+        // Change info is now all ready, so the notifiers can now perform their
+        // background work
+        for (auto& notifier : group.notifiers) {
+            run(notifier);
+        }
+    });
 
     // Reacquire the lock while updating the fields that are actually read on
     // other threads
     util::CheckedLockGuard lock2(m_notifier_mutex);
-    for (auto& notifier : new_notifiers) {
-        notifier->prepare_handover();
-    }
-    for (auto& notifier : notifiers) {
-        notifier->prepare_handover();
-    }
+    for_each_group([&](NotifierGroup& group) {
+        for (auto& notifier : group.new_notifiers) {
+            notifier->prepare_handover();
+        }
+        for (auto& notifier : group.notifiers) {
+            notifier->prepare_handover();
+        }
+    });
     clean_up_dead_notifiers();
     m_notifier_cv.notify_all();
 }
 
+VersionID RealmCoordinator::get_latest_version_id()
+{
+    // Checking the latest version number is very cheap, but we need the full
+    // VersionID to be able to advance to it. Advancing an existing read
+    // transaction which has no accessors is much cheaper than creating a new
+    // one, and in the common case where nothing has changed since the last
+    // check we can skip even that.
+    if (!m_latest_version_sg)
+        m_latest_version_sg = m_db->start_read();
+    else if (m_db->get_version_of_latest_snapshot() != m_latest_version_sg->get_version_of_current_transaction().version)
+        m_latest_version_sg->advance_read();
+    return m_latest_version_sg->get_version_of_current_transaction();
+}
+
 bool RealmCoordinator::can_advance(Realm& realm)
 {
     bool changes = realm.last_seen_transaction_version() != m_db->get_version_of_latest_snapshot();
@@ -1044,7 +1260,7 @@ void RealmCoordinator::advance_to_ready(Realm& realm)
         }
     }
 
-    transaction::advance(sg, realm.m_binding_context.get(), notifiers);
+    transaction::advance(sg, realm.m_binding_context.get(), notifiers, m_change_info_cache.get());
 }
 
 std::vector<std::shared_ptr<_impl::CollectionNotifier>> RealmCoordinator::notifiers_for_realm(Realm& realm)
@@ -1072,7 +1288,7 @@ bool RealmCoordinator::advance_to_latest(Realm& realm)
     notifiers.package_and_wait(sg->get_version_of_latest_snapshot());
 
     auto version = sg->get_version_of_current_transaction();
-    transaction::advance(sg, realm.m_binding_context.get(), notifiers);
+    transaction::advance(sg, realm.m_binding_context.get(), notifiers, m_change_info_cache.get());
 
     // Realm could be closed in the callbacks.
     if (realm.is_closed())
@@ -1151,6 +1367,7 @@ void RealmCoordinator::set_transaction_callback(std::function<void(VersionID, Ve
 
 bool RealmCoordinator::compact()
 {
+    m_change_info_cache->clear();
     return m_db->compact();
 }
 
@@ -21,10 +21,12 @@
 
 #include "shared_realm.hpp"
 
+#include "impl/notifier_statistics.hpp"
 #include "util/checked_mutex.hpp"
 
 #include <realm/version_id.hpp>
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
@@ -37,8 +39,10 @@ class SyncSession;
 class Transaction;
 
 namespace _impl {
+class ChangeInfoCache;
 class CollectionNotifier;
 class ExternalCommitHelper;
+class NotifierWorkerPool;
 class WeakRealmNotifier;
 
 namespace partial_sync {
@@ -121,6 +125,13 @@ public:
     void send_commit_notifications(Realm&);
     void wake_up_notifier_worker();
 
+    // Call notify() on every Realm instance for this coordinator's path in
+    // this process, without checking for new commits first
+    void notify_realms() REQUIRES(!m_realm_mutex);
+    // Call notify_realms() once `time` has passed. Used to deliver
+    // notifications which were held back by a minimum delivery interval.
+    void notify_realms_at(std::chrono::steady_clock::time_point time);
+
     // Clear the weak Realm cache for all paths
     // Should only be called in test code, as continuing to use the previously
     // cached instances will have odd results
@@ -142,8 +153,16 @@ public:
 
     // Called by m_notifier when there's a new commit to send notifications for
     void on_change() REQUIRES(!m_realm_mutex, !m_notifier_mutex);
+    // Called by m_notifier instead of on_change(). Calls on_change() either
+    // immediately on the calling thread or on the shared NotifierExecutor if
+    // that has been enabled. Never extends the lifetime of the coordinator.
+    void on_external_change() REQUIRES(!m_realm_mutex, !m_notifier_mutex);
 
-    static void register_notifier(std::shared_ptr<CollectionNotifier> notifier);
+    // Register a notifier to be run on the notifier worker thread. If there is
+    // already a notifier registered for the same Realm which can be shared
+    // with the new one, that notifier is returned instead and the new one is
+    // not registered. Callers must use the returned notifier.
+    static std::shared_ptr<CollectionNotifier> register_notifier(std::shared_ptr<CollectionNotifier> notifier);
 
     std::shared_ptr<Group> begin_read(VersionID version={}, bool frozen_transaction = false);
 
@@ -162,6 +181,11 @@ public:
     // Deliver any notifications which are ready for the Realm's version
     void process_available_async(Realm& realm) REQUIRES(!m_notifier_mutex);
 
+    // Get the current timings for each stage of running notifiers and
+    // delivering notifications for this coordinator. Cheap enough to be polled
+    // frequently, and can be called from any thread.
+    NotifierStatistics::Snapshot get_notifier_statistics() const noexcept { return m_notifier_statistics.snapshot(); }
+
     // Register a function which is called whenever sync makes a write to the Realm
     void set_transaction_callback(std::function<void(VersionID, VersionID)>) REQUIRES(!m_transaction_callback_mutex);
 
@@ -192,6 +216,9 @@ public:
 
 private:
     friend Realm::Internal;
+    // Set by get_coordinator(); used to hand the coordinator to other threads
+    // without creating a strong reference on the calling thread
+    std::weak_ptr<RealmCoordinator> m_weak_self;
     Realm::Config m_config;
     std::unique_ptr<Replication> m_history;
     std::shared_ptr<DB> m_db;
@@ -222,6 +249,25 @@ private:
     std::shared_ptr<Transaction> m_advancer_sg;
     std::exception_ptr m_async_error;
 
+    // Transaction used only to look up the VersionID of the latest version in
+    // run_async_notifiers(). This is kept around and advanced rather than
+    // starting a new read transaction each time, as that's comparatively slow.
+    // Released along with m_notifier_sg
+    std::shared_ptr<Transaction> m_latest_version_sg;
+
+    // Transactions used for running async notifiers in parallel when
+    // m_config.notifier_thread_count is greater than one. Worker group zero
+    // uses m_notifier_sg, and group N uses m_notifier_worker_sgs[N - 1], which
+    // will have a read transaction iff that group has any notifiers
+    std::vector<std::shared_ptr<Transaction>> m_notifier_worker_sgs;
+    std::unique_ptr<_impl::NotifierWorkerPool> m_notifier_worker_pool;
+
+    _impl::NotifierStatistics m_notifier_statistics;
+
+    // Changes parsed from the transaction logs by recent advances, shared by
+    // the notifier Transactions and the Realms for this file
+    std::unique_ptr<_impl::ChangeInfoCache> m_change_info_cache;
+
     std::unique_ptr<_impl::ExternalCommitHelper> m_notifier;
     util::CheckedMutex m_transaction_callback_mutex;
     std::function<void(VersionID, VersionID)> m_transaction_callback GUARDED_BY(m_transaction_callback_mutex);
@@ -243,6 +289,7 @@ private:
                       util::Optional<VersionID> version,
                       util::CheckedUniqueLock& realm_lock) REQUIRES(m_realm_mutex);
     void run_async_notifiers() REQUIRES(!m_notifier_mutex);
+    VersionID get_latest_version_id() REQUIRES(m_notifier_mutex);
     void advance_helper_shared_group_to_latest();
     void clean_up_dead_notifiers() REQUIRES(m_notifier_mutex);
 
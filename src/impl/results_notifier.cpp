@@ -20,6 +20,9 @@
 
 #include "shared_realm.hpp"
 
+#include <realm/util/to_string.hpp>
+
+#include <algorithm>
 #include <numeric>
 
 using namespace realm;
@@ -41,6 +44,8 @@ using namespace realm::_impl;
 //     - Reads m_query
 //     - Reads m_info
 //     - Reads m_need_to_run <-- FIXME: data race?
+//     - Reads m_results_were_used with target lock held
+//     - Writes m_tableview_requested with target lock held
 //     - Writes m_run_tv
 //   * do_prepare_handover() called with notifier lock held
 //     - Reads m_run_tv
@@ -56,6 +61,12 @@ using namespace realm::_impl;
 //     - Reads m_deliver_transaction
 //     - Reads m_deliver_handover
 //     - Reads m_results_were_used
+//     - Writes m_delivered_tv_was_used
+//     - Writes m_tableview_requested with target lock held
+//
+// A ResultsNotifier can be shared by multiple Results for the same Realm which
+// have the same query and ordering. As all of the Results are on the same
+// thread, this only changes what get_tableview() does.
 
 ResultsNotifier::ResultsNotifier(Results& target)
 : ResultsNotifierBase(target.get_realm())
@@ -66,9 +77,30 @@ ResultsNotifier::ResultsNotifier(Results& target)
     auto table = m_query->get_table();
     if (table) {
         set_table(table);
+
+        // Queries restricted to a view (such as a LinkList) aren't fully
+        // described by their serialized form, so those are never shared
+        if (m_query->produces_results_in_table_order()) {
+            try {
+                m_sharing_key = util::format("%1 %2 %3", table->get_key().value,
+                                             m_query->get_description(),
+                                             m_descriptor_ordering.get_description(table));
+            }
+            catch (...) {
+                // Not all queries can be serialized, and those just aren't shared
+            }
+        }
     }
 }
 
+bool ResultsNotifier::can_share(CollectionNotifier const& other) const
+{
+    if (m_sharing_key.empty())
+        return false;
+    auto results_notifier = dynamic_cast<ResultsNotifier const*>(&other);
+    return results_notifier && results_notifier->m_sharing_key == m_sharing_key;
+}
+
 void ResultsNotifier::release_data() noexcept
 {
     m_query = {};
@@ -82,12 +114,30 @@ void ResultsNotifier::release_data() noexcept
 
 bool ResultsNotifier::get_tableview(TableView& out)
 {
-    if (!m_delivered_tv)
+    if (!m_delivered_tv) {
+        // run_incrementally() skips producing a TableView when the previous
+        // ones weren't used, so if the Results now needs one make sure that
+        // the next run produces it
+        if (!out.is_attached() || !out.is_in_sync()) {
+            auto lock = lock_target();
+            m_tableview_requested = true;
+        }
         return false;
+    }
     auto& transaction = source_shared_group();
     if (m_delivered_transaction->get_version_of_current_transaction() != transaction.get_version_of_current_transaction())
         return false;
 
+    if (is_shared()) {
+        // Each of the Results sharing this notifier needs a copy of the
+        // TableView. Results asks for it every time it's evaluated, so skip
+        // copying it again if `out` is already up to date.
+        if (!out.is_attached() || !out.is_in_sync())
+            out = std::move(*transaction.import_copy_of(*m_delivered_tv, PayloadPolicy::Copy));
+        m_delivered_tv_was_used = true;
+        return true;
+    }
+
     out = std::move(*transaction.import_copy_of(*m_delivered_tv, PayloadPolicy::Move));
     m_delivered_tv.reset();
     return true;
@@ -106,8 +156,10 @@ bool ResultsNotifier::need_to_run()
     {
         auto lock = lock_target();
         // Don't run the query if the results aren't actually going to be used
-        if (!get_realm() || (!have_callbacks() && !m_results_were_used))
+        if (!get_realm() || (!have_callbacks() && !m_results_were_used)) {
+            m_previous_rows_are_current = false;
             return false;
+        }
     }
 
     // If we've run previously, check if we need to rerun
@@ -120,17 +172,44 @@ bool ResultsNotifier::need_to_run()
     return true;
 }
 
+namespace {
+// A DeepChangeChecker reads the notifier's Transaction, which can't be used
+// from several threads at once, so only the checkers which just read the
+// change info are copied to the pool's threads to check ranges in parallel
+template<typename Checker>
+CollectionChangeBuilder calculate_row_changes(std::vector<int64_t> const& prev_rows,
+                                              std::vector<int64_t> const& next_rows, Checker& checker,
+                                              bool in_table_order, NotifierWorkerPool* pool)
+{
+    size_t row_count = std::max(prev_rows.size(), next_rows.size());
+    if (pool && row_count >= CollectionChangeBuilder::default_parallel_calculation_threshold)
+        return CollectionChangeBuilder::calculate_parallel(prev_rows, next_rows, checker, in_table_order, *pool);
+    return CollectionChangeBuilder::calculate(prev_rows, next_rows, checker, in_table_order);
+}
+
+CollectionChangeBuilder calculate_row_changes(std::vector<int64_t> const& prev_rows,
+                                              std::vector<int64_t> const& next_rows, DeepChangeChecker& checker,
+                                              bool in_table_order, NotifierWorkerPool*)
+{
+    return CollectionChangeBuilder::calculate(prev_rows, next_rows, checker, in_table_order);
+}
+} // anonymous namespace
+
 void ResultsNotifier::calculate_changes()
 {
+    LatencyHistogram::Timer timer(timings(&NotifierStatistics::calculate_changes));
     if (has_run() && have_callbacks()) {
         std::vector<int64_t> next_rows;
         next_rows.reserve(m_run_tv.size());
         for (size_t i = 0; i < m_run_tv.size(); ++i)
             next_rows.push_back(m_run_tv.get_key(i).value);
 
-        m_change = CollectionChangeBuilder::calculate(m_previous_rows, next_rows,
-                                                      get_modification_checker(*m_info, m_query->get_table()),
-                                                      m_target_is_in_table_order);
+        m_change = with_modification_checker(*m_info, m_query->get_table(), next_rows.size(), [&](auto& checker) {
+            return calculate_row_changes(m_previous_rows, next_rows, checker, m_target_is_in_table_order,
+                                         worker_pool());
+        });
+        calculate_filtered_changes(*m_info, m_query->get_table(), next_rows.size(),
+                                   [&](size_t i) { return next_rows[i]; });
 
         m_previous_rows = std::move(next_rows);
     }
@@ -154,13 +233,130 @@ void ResultsNotifier::run()
     if (!need_to_run())
         return;
 
-    m_query->sync_view_if_needed();
-    m_run_tv = m_query->find_all();
-    m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
-    m_run_tv.sync_if_needed();
-    m_last_seen_version = m_run_tv.ObjList::get_dependency_versions();
+    if (run_incrementally())
+        return;
+
+    {
+        LatencyHistogram::Timer timer(timings(&NotifierStatistics::run_query));
+        m_query->sync_view_if_needed();
+        m_run_tv = m_query->find_all();
+        m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
+        m_run_tv.sync_if_needed();
+        m_last_seen_version = m_run_tv.ObjList::get_dependency_versions();
+    }
 
     calculate_changes();
+    m_previous_rows_are_current = true;
+}
+
+// For unsorted queries which only depend on the properties of the objects
+// being queried, an object can only enter or leave the results if it was
+// inserted, deleted or modified, so rather than rerunning the query and
+// diffing the entire old and new results we can check just the changed
+// objects against the query and merge them into the previous results.
+bool ResultsNotifier::run_incrementally()
+{
+    if (!m_previous_rows_are_current || !have_callbacks() || m_info->schema_changed)
+        return false;
+    if (!m_target_is_in_table_order || !m_descriptor_ordering.is_empty() || !m_query->produces_results_in_table_order())
+        return false;
+    // Queries over links or backlinks depend on more than one table
+    if (m_last_seen_version.size() != 1)
+        return false;
+
+    auto table = m_query->get_table();
+    for (auto col_key : table->get_column_keys()) {
+        auto type = table->get_column_type(col_key);
+        if (type == type_Link || type == type_LinkList)
+            return false;
+    }
+
+    // The table may be missing if callbacks were added after the change info
+    // was gathered, in which case we don't know what changed
+    auto it = m_info->tables.find(table->get_key().value);
+    if (it == m_info->tables.end() || it->second.clear_did_occur())
+        return false;
+    auto& changes = it->second;
+
+    // Evaluating the query for a single object is much slower per object than
+    // running it over the whole table, so past a certain point it's faster to
+    // just rerun it
+    size_t changed = changes.insertions_size() + changes.deletions_size() + changes.modifications_size();
+    if (changed > 16 && changed * 16 > m_previous_rows.size())
+        return false;
+
+    {
+        LatencyHistogram::Timer timer(timings(&NotifierStatistics::calculate_changes));
+        std::vector<int64_t> keys;
+        keys.reserve(changed);
+        keys.insert(keys.end(), changes.get_insertions().begin(), changes.get_insertions().end());
+        keys.insert(keys.end(), changes.get_deletions().begin(), changes.get_deletions().end());
+        for (auto& modification : changes.get_modifications())
+            keys.push_back(modification.first);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        // Results in table order are sorted by key, so the changed objects can be
+        // merged into the previous rows in a single pass
+        REALM_ASSERT_DEBUG(std::is_sorted(m_previous_rows.begin(), m_previous_rows.end()));
+        std::vector<int64_t> next_rows;
+        next_rows.reserve(m_previous_rows.size() + changes.insertions_size());
+        m_change = {};
+
+        auto prev = m_previous_rows.begin();
+        auto prev_end = m_previous_rows.end();
+        for (auto key : keys) {
+            auto pos = std::lower_bound(prev, prev_end, key);
+            next_rows.insert(next_rows.end(), prev, pos);
+            prev = pos;
+
+            bool was_present = prev != prev_end && *prev == key;
+            bool is_present = false;
+            if (table->is_valid(ObjKey(key))) {
+                auto obj = table->get_object(ObjKey(key));
+                is_present = m_query->eval_object(obj);
+            }
+
+            if (was_present) {
+                size_t old_index = prev - m_previous_rows.begin();
+                ++prev;
+                if (!is_present) {
+                    m_change.deletions.add(old_index);
+                    continue;
+                }
+                if (changes.modifications_contains(key, filtered_root_columns()))
+                    m_change.modifications.add(next_rows.size());
+                next_rows.push_back(key);
+            }
+            else if (is_present) {
+                m_change.insertions.add(next_rows.size());
+                next_rows.push_back(key);
+            }
+        }
+        next_rows.insert(next_rows.end(), prev, prev_end);
+
+        m_previous_rows = std::move(next_rows);
+        calculate_filtered_changes(*m_info, table, m_previous_rows.size(),
+                                   [&](size_t i) { return m_previous_rows[i]; });
+    }
+    m_last_seen_version = m_query->sync_view_if_needed();
+
+    // TableView has no way to apply changes to an existing view, so if the
+    // Results is going to use the TableView we still need to run the query,
+    // but if only the callbacks are being used we can skip it entirely
+    bool results_will_be_used;
+    {
+        auto lock = lock_target();
+        results_will_be_used = m_results_were_used || m_tableview_requested;
+        m_tableview_requested = false;
+    }
+    if (results_will_be_used) {
+        LatencyHistogram::Timer timer(timings(&NotifierStatistics::run_query));
+        m_run_tv = m_query->find_all();
+        m_run_tv.sync_if_needed();
+        REALM_ASSERT_DEBUG(m_run_tv.size() == m_previous_rows.size());
+    }
+    return true;
 }
 
 void ResultsNotifier::do_prepare_handover(Transaction& sg)
@@ -197,7 +393,8 @@ bool ResultsNotifier::prepare_to_deliver()
         return true;
     }
 
-    m_results_were_used = !m_delivered_tv;
+    m_results_were_used = !m_delivered_tv || m_delivered_tv_was_used;
+    m_delivered_tv_was_used = false;
     m_delivered_tv.reset();
     if (m_delivered_transaction)
         m_delivered_transaction->advance_read(m_handover_transaction->get_version_of_current_transaction());
@@ -277,6 +474,7 @@ bool ListResultsNotifier::need_to_run()
 
 void ListResultsNotifier::calculate_changes()
 {
+    LatencyHistogram::Timer timer(timings(&NotifierStatistics::calculate_changes));
     // Unsorted lists can just forward the changeset directly from the
     // transaction log parsing, but sorted lists need to perform diffing
     if (has_run() && have_callbacks() && (m_sort_order || m_distinct)) {
@@ -313,14 +511,17 @@ void ListResultsNotifier::run()
     if (!need_to_run())
         return;
 
-    m_run_indices = std::vector<size_t>();
-    if (m_distinct)
-        m_list->distinct(*m_run_indices, m_sort_order);
-    else if (m_sort_order)
-        m_list->sort(*m_run_indices, *m_sort_order);
-    else {
-        m_run_indices->resize(m_list->size());
-        std::iota(m_run_indices->begin(), m_run_indices->end(), 0);
+    {
+        LatencyHistogram::Timer timer(timings(&NotifierStatistics::run_query));
+        m_run_indices = std::vector<size_t>();
+        if (m_distinct)
+            m_list->distinct(*m_run_indices, m_sort_order);
+        else if (m_sort_order)
+            m_list->sort(*m_run_indices, *m_sort_order);
+        else {
+            m_run_indices->resize(m_list->size());
+            std::iota(m_run_indices->begin(), m_run_indices->end(), 0);
+        }
     }
 
     calculate_changes();
@@ -39,12 +39,18 @@ class ResultsNotifier : public ResultsNotifierBase {
 public:
     ResultsNotifier(Results& target);
     bool get_tableview(TableView& out) override;
+    bool can_share(CollectionNotifier const& other) const override;
 
 private:
     std::unique_ptr<Query> m_query;
     DescriptorOrdering m_descriptor_ordering;
     bool m_target_is_in_table_order;
 
+    // A serialized form of the table, query and ordering which is used to
+    // identify Results which can share a notifier. Empty if the query can't
+    // be shared. Never modified after construction.
+    std::string m_sharing_key;
+
     // The TableView resulting from running the query. Will be detached unless
     // the query was (re)run since the last time the handover object was created
     TableView m_run_tv;
@@ -60,12 +66,22 @@ private:
 
     // The rows from the previous run of the query, for calculating diffs
     std::vector<int64_t> m_previous_rows;
+    // False if the query was skipped for a version which may have changed the
+    // results, in which case m_previous_rows can't be updated incrementally
+    bool m_previous_rows_are_current = false;
 
     TransactionChangeInfo* m_info = nullptr;
     bool m_results_were_used = true;
+    // Set when get_tableview() is called while the Results has an out of date
+    // TableView and there isn't a new one to deliver
+    bool m_tableview_requested = false;
+    // Set when get_tableview() copies m_delivered_tv rather than moving it
+    // out, which is done when the notifier is shared
+    bool m_delivered_tv_was_used = false;
 
     bool need_to_run();
     void calculate_changes();
+    bool run_incrementally();
 
     void run() override;
     void do_prepare_handover(Transaction&) override;
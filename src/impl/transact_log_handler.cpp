@@ -19,6 +19,7 @@
 #include "impl/transact_log_handler.hpp"
 
 #include "binding_context.hpp"
+#include "impl/change_info_cache.hpp"
 #include "impl/collection_notifier.hpp"
 #include "index_set.hpp"
 #include "shared_realm.hpp"
@@ -27,6 +28,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <unordered_map>
 
 using namespace realm;
 
@@ -259,25 +261,101 @@ class TransactLogObserver : public TransactLogValidationMixin {
     _impl::CollectionChangeBuilder* m_active_list = nullptr;
     ObjectChangeSet* m_active_table = nullptr;
 
+    // The observed lists are indexed by the object which owns them so that
+    // each instruction takes constant time no matter how many lists are
+    // observed. Lists whose object is deleted are only marked as removed
+    // while parsing, as removing them from m_info.lists would invalidate the
+    // indexes, and are then removed in parse_complete().
+    struct ListOwner {
+        _impl::TableKeyType table_key;
+        _impl::ObjKeyType obj_key;
+
+        bool operator==(ListOwner const& other) const noexcept
+        {
+            return table_key == other.table_key && obj_key == other.obj_key;
+        }
+    };
+    struct ListOwnerHash {
+        size_t operator()(ListOwner const& owner) const noexcept
+        {
+            return std::hash<_impl::ObjKeyType>()(owner.obj_key) ^ (size_t(owner.table_key) * 0x9E3779B9);
+        }
+    };
+    // The indexes in m_info.lists of the lists of each object, in order
+    std::unordered_map<ListOwner, std::vector<size_t>, ListOwnerHash> m_lists_by_owner;
+    // The objects in each table which own at least one list
+    std::unordered_map<_impl::TableKeyType, std::vector<_impl::ObjKeyType>> m_list_owners_by_table;
+    std::vector<bool> m_list_removed;
+    bool m_lists_indexed = false;
+    bool m_any_list_removed = false;
+
+    // The index is built on first use rather than in the constructor as
+    // KVOAdapter adds its lists after this has been constructed
+    void index_lists()
+    {
+        if (m_lists_indexed)
+            return;
+        m_lists_indexed = true;
+        m_list_removed.assign(m_info.lists.size(), false);
+        for (size_t i = 0; i < m_info.lists.size(); ++i) {
+            auto& list = m_info.lists[i];
+            auto& lists = m_lists_by_owner[{list.table_key.value, list.row_key}];
+            if (lists.empty())
+                m_list_owners_by_table[list.table_key.value].push_back(list.row_key);
+            lists.push_back(i);
+        }
+    }
+
     _impl::CollectionChangeBuilder* find_list(ObjKey obj, ColKey col)
     {
+        if (m_info.lists.empty())
+            return nullptr;
+        index_lists();
+        auto it = m_lists_by_owner.find({current_table().value, obj.value});
+        if (it == m_lists_by_owner.end())
+            return nullptr;
+
         // When there are multiple source versions there could be multiple
         // change objects for a single LinkView, in which case we need to use
         // the last one
-        auto table = current_table();
-        for (auto it = m_info.lists.rbegin(), end = m_info.lists.rend(); it != end; ++it) {
-            if (it->table_key == table && it->row_key == obj.value && it->col_key == col.value)
-                return it->changes;
+        for (auto i = it->second.rbegin(), end = it->second.rend(); i != end; ++i) {
+            if (m_info.lists[*i].col_key == col.value)
+                return m_info.lists[*i].changes;
         }
         return nullptr;
     }
 
+    void remove_lists(ListOwner const& owner)
+    {
+        auto it = m_lists_by_owner.find(owner);
+        if (it == m_lists_by_owner.end())
+            return;
+        for (size_t i : it->second)
+            m_list_removed[i] = true;
+        m_lists_by_owner.erase(it);
+        m_any_list_removed = true;
+    }
+
 public:
     TransactLogObserver(_impl::TransactionChangeInfo& info)
     : m_info(info) { }
 
     void parse_complete()
     {
+        if (m_any_list_removed) {
+            size_t kept = 0;
+            for (size_t i = 0; i < m_info.lists.size(); ++i) {
+                if (!m_list_removed[i])
+                    m_info.lists[kept++] = std::move(m_info.lists[i]);
+            }
+            m_info.lists.erase(m_info.lists.begin() + kept, m_info.lists.end());
+        }
+        m_lists_by_owner.clear();
+        m_list_owners_by_table.clear();
+        m_list_removed.clear();
+        m_lists_indexed = false;
+        m_any_list_removed = false;
+
         for (auto& list : m_info.lists)
             list.changes->clean_up_stale_moves();
         for (auto it = m_info.tables.begin(); it != m_info.tables.end(); ) {
@@ -374,16 +452,9 @@ public:
             m_active_table->deletions_add(key.value);
         m_active_table->modifications_remove(key.value);
 
-        for (size_t i = 0; i < m_info.lists.size(); ++i) {
-            auto& list = m_info.lists[i];
-            if (list.table_key != current_table())
-                continue;
-            if (list.row_key == key.value) {
-                if (i + 1 < m_info.lists.size())
-                    m_info.lists[i] = std::move(m_info.lists.back());
-                m_info.lists.pop_back();
-                continue;
-            }
+        if (!m_info.lists.empty()) {
+            index_lists();
+            remove_lists({current_table().value, key.value});
         }
 
         return true;
@@ -401,9 +472,16 @@ public:
         auto cur_table = current_table();
         if (m_active_table)
             m_active_table->clear(old_size);
-        auto it = remove_if(begin(m_info.lists), end(m_info.lists),
-                            [&](auto const& lv) { return lv.table_key == cur_table; });
-        m_info.lists.erase(it, end(m_info.lists));
+        if (m_info.lists.empty())
+            return true;
+
+        index_lists();
+        auto it = m_list_owners_by_table.find(cur_table.value);
+        if (it != m_list_owners_by_table.end()) {
+            for (auto obj_key : it->second)
+                remove_lists({cur_table.value, obj_key});
+            m_list_owners_by_table.erase(it);
+        }
         return true;
     }
 
@@ -452,10 +530,48 @@ public:
     }
 };
 
+// Advance to the version the notifiers are ready for (or the latest version)
+// using changes which were already parsed for the notifiers rather than
+// parsing the transaction logs again. Only possible if the cache has the
+// exact range being advanced over and none of the observed objects have list
+// properties, as list changes aren't cached. Returns false without doing
+// anything if the logs need to be parsed.
+bool advance_from_cache(_impl::ChangeInfoCache& cache, BindingContext* context, Transaction& sg,
+                        std::vector<BindingContext::ObserverState>& observers,
+                        _impl::NotifierPackage& notifiers)
+{
+    auto from = sg.get_version_of_current_transaction().version;
+    auto to = notifiers.version() ? notifiers.version()->version : sg.get_version_of_latest_snapshot();
+    if (from == to)
+        return false;
+
+    KVOAdapter adapter(observers, context);
+    if (!adapter.lists.empty())
+        return false;
+    auto entry = cache.find(from, to);
+    if (!entry)
+        return false;
+    entry->copy_to(adapter);
+
+    if (context)
+        context->will_send_notifications();
+    adapter.before(sg);
+    notifiers.package_and_wait(entry->to.version);
+    notifiers.before_advance();
+    sg.advance_read(entry->to);
+    adapter.after(sg);
+    notifiers.after_advance();
+    if (context)
+        context->did_send_notifications();
+    return true;
+}
+
+// `cache` may only be supplied if `func` advances the read transaction
 template<typename Func>
 void advance_with_notifications(BindingContext* context,
                                 const std::shared_ptr<Transaction>& sg,
-                                Func&& func, _impl::NotifierPackage& notifiers)
+                                Func&& func, _impl::NotifierPackage& notifiers,
+                                _impl::ChangeInfoCache* cache=nullptr)
 {
     auto old_version = sg->get_version_of_current_transaction();
     std::vector<BindingContext::ObserverState> observers;
@@ -489,6 +605,11 @@ void advance_with_notifications(BindingContext* context,
         return;
     }
 
+    if (cache && !observers.empty())
+        cache->set_has_observers();
+    if (cache && advance_from_cache(*cache, context, *sg, observers, notifiers))
+        return;
+
     if (context)
         context->will_send_notifications();
     {
@@ -518,11 +639,12 @@ void advance(Transaction& tr, BindingContext*, VersionID version)
     tr.advance_read(&validator, version);
 }
 
-void advance(const std::shared_ptr<Transaction>& tr, BindingContext* context, NotifierPackage& notifiers)
+void advance(const std::shared_ptr<Transaction>& tr, BindingContext* context, NotifierPackage& notifiers,
+             ChangeInfoCache* cache)
 {
     advance_with_notifications(context, tr, [&](auto&&... args) {
         tr->advance_read(std::move(args)..., notifiers.version().value_or(VersionID{}));
-    }, notifiers);
+    }, notifiers, cache);
 }
 
 void begin(const std::shared_ptr<Transaction>& tr, BindingContext* context, NotifierPackage& notifiers)
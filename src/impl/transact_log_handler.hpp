@@ -30,6 +30,7 @@ class BindingContext;
 class Transaction;
 
 namespace _impl {
+class ChangeInfoCache;
 class NotifierPackage;
 struct TransactionChangeInfo;
 
@@ -40,7 +41,10 @@ struct UnsupportedSchemaChange : std::logic_error {
 namespace transaction {
 // Advance the read transaction version, with change notifications sent to delegate
 // Must not be called from within a write transaction.
-void advance(const std::shared_ptr<Transaction>& sg, BindingContext* binding_context, NotifierPackage&);
+// If a cache is supplied, the changes are read from it rather than from the
+// transaction logs when possible.
+void advance(const std::shared_ptr<Transaction>& sg, BindingContext* binding_context, NotifierPackage&,
+             ChangeInfoCache* cache=nullptr);
 void advance(Transaction& sg, BindingContext* binding_context, VersionID);
 
 // Begin a write transaction
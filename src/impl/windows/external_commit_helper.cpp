@@ -63,7 +63,7 @@ void ExternalCommitHelper::listen()
     while (m_keep_listening) {
         m_commit_available.wait(m_mutex, nullptr);
         if (m_keep_listening) {
-			m_parent.on_change();
+			m_parent.on_external_change();
         }
     }
 }
@@ -21,25 +21,95 @@
 #include <realm/util/assert.hpp>
 
 #include <algorithm>
+#include <cstddef>
 
 using namespace realm;
 using namespace realm::_impl;
 
 const size_t IndexSet::npos;
 
+namespace {
+// The lowest set bit of `i`, for navigating the Fenwick tree
+size_t lowest_bit(size_t i) noexcept
+{
+    return i & (~i + 1);
+}
+
+// Large enough to hold a few full chunks so that most allocations don't need a
+// new block
+const size_t arena_block_size = 64 * 1024;
+const size_t arena_alignment = alignof(std::max_align_t);
+
+thread_local ChunkArena* s_current_arena = nullptr;
+} // anonymous namespace
+
+void* ChunkArena::allocate(size_t size)
+{
+    size = (size + arena_alignment - 1) & ~(arena_alignment - 1);
+    m_bytes_allocated += size;
+
+    // Allocations which would use up most of a block get a block of their own
+    // so that the remainder of the current block isn't wasted
+    if (size > arena_block_size / 4) {
+        m_blocks.emplace_back(new char[size]);
+        return m_blocks.back().get();
+    }
+
+    if (size > m_remaining) {
+        m_blocks.emplace_back(new char[arena_block_size]);
+        m_next = m_blocks.back().get();
+        m_remaining = arena_block_size;
+    }
+    void* ret = m_next;
+    m_next += size;
+    m_remaining -= size;
+    return ret;
+}
+
+void ChunkArena::reset() noexcept
+{
+    m_blocks.clear();
+    m_next = nullptr;
+    m_remaining = 0;
+    m_bytes_allocated = 0;
+}
+
+ChunkArena* ChunkArena::current() noexcept
+{
+    return s_current_arena;
+}
+
+ChunkArena::Scope::Scope(ChunkArena& arena) noexcept
+: m_previous(s_current_arena)
+{
+    s_current_arena = &arena;
+}
+
+ChunkArena::Scope::Scope(std::nullptr_t) noexcept
+: m_previous(s_current_arena)
+{
+    s_current_arena = nullptr;
+}
+
+ChunkArena::Scope::~Scope()
+{
+    s_current_arena = m_previous;
+}
+
 template<typename T>
 void MutableChunkedRangeVectorIterator<T>::set(size_t front, size_t back)
 {
-    this->m_outer->count -= this->m_inner->second - this->m_inner->first;
+    ptrdiff_t delta = (back - front) - (this->m_inner->second - this->m_inner->first);
     if (this->offset() == 0) {
         this->m_outer->begin = front;
     }
     if (this->m_inner == &this->m_outer->data.back()) {
         this->m_outer->end = back;
     }
-    this->m_outer->count += back - front;
+    this->m_outer->count += delta;
     this->m_inner->first = front;
     this->m_inner->second = back;
+    m_parent->chunk_count_changed(this->m_outer - m_parent->m_data.begin(), delta);
 }
 
 template<typename T>
@@ -54,6 +124,7 @@ void MutableChunkedRangeVectorIterator<T>::adjust(ptrdiff_t front, ptrdiff_t bac
     this->m_outer->count += -front + back;
     this->m_inner->first += front;
     this->m_inner->second += back;
+    m_parent->chunk_count_changed(this->m_outer - m_parent->m_data.begin(), -front + back);
 }
 
 template<typename T>
@@ -78,9 +149,15 @@ void ChunkedRangeVector::push_back(value_type value)
         range.data.push_back(value);
         range.count += value.second - value.first;
         range.end = value.second;
+        chunk_count_changed(m_data.size() - 1, value.second - value.first);
     }
     else {
         m_data.push_back({{value}, value.first, value.second, value.second - value.first});
+
+        // Appending to a Fenwick tree only requires summing the chunks which
+        // the new node covers rather than a full rebuild
+        size_t i = m_data.size();
+        m_count_tree.push_back(m_data.back().count + count_before(i - 1) - count_before(i - lowest_bit(i)));
     }
     verify();
 }
@@ -98,6 +175,7 @@ ChunkedRangeVector::iterator ChunkedRangeVector::insert(iterator pos, value_type
     chunk.count += value.second - value.first;
     chunk.begin = std::min(chunk.begin, value.first);
     chunk.end = std::max(chunk.end, value.second);
+    chunk_count_changed(pos.m_outer - m_data.begin(), value.second - value.first);
 
     verify();
     return pos;
@@ -137,6 +215,7 @@ ChunkedRangeVector::iterator ChunkedRangeVector::ensure_space(iterator pos)
     }
     pos.m_end = m_data.end();
     pos.m_inner = &pos.m_outer->data[offset];
+    rebuild_count_tree();
     verify();
     return pos;
 }
@@ -145,16 +224,19 @@ ChunkedRangeVector::iterator ChunkedRangeVector::erase(iterator pos) noexcept
 {
     auto offset = pos.offset();
     auto& chunk = *pos.m_outer;
-    chunk.count -= pos->second - pos->first;
+    size_t removed = pos->second - pos->first;
+    chunk.count -= removed;
     chunk.data.erase(chunk.data.begin() + offset);
 
     if (chunk.data.size() == 0) {
         pos.m_outer = m_data.erase(pos.m_outer);
         pos.m_end = m_data.end();
         pos.m_inner = pos.m_outer == m_data.end() ? nullptr : &pos.m_outer->data.front();
+        rebuild_count_tree();
         verify();
         return pos;
     }
+    chunk_count_changed(pos.m_outer - m_data.begin(), -ptrdiff_t(removed));
 
     chunk.begin = chunk.data.front().first;
     chunk.end = chunk.data.back().second;
@@ -169,6 +251,33 @@ ChunkedRangeVector::iterator ChunkedRangeVector::erase(iterator pos) noexcept
     return pos;
 }
 
+size_t ChunkedRangeVector::count_before(size_t chunk_index) const noexcept
+{
+    size_t count = 0;
+    for (size_t i = chunk_index; i > 0; i -= lowest_bit(i))
+        count += m_count_tree[i - 1];
+    return count;
+}
+
+void ChunkedRangeVector::chunk_count_changed(size_t chunk_index, ptrdiff_t delta) noexcept
+{
+    for (size_t i = chunk_index + 1; i <= m_count_tree.size(); i += lowest_bit(i))
+        m_count_tree[i - 1] += delta;
+}
+
+void ChunkedRangeVector::rebuild_count_tree()
+{
+    size_t size = m_data.size();
+    m_count_tree.resize(size);
+    for (size_t i = 0; i < size; ++i)
+        m_count_tree[i] = m_data[i].count;
+    for (size_t i = 1; i <= size; ++i) {
+        size_t parent = i + lowest_bit(i);
+        if (parent <= size)
+            m_count_tree[parent - 1] += m_count_tree[i - 1];
+    }
+}
+
 void ChunkedRangeVector::verify() const noexcept
 {
 #ifdef REALM_DEBUG
@@ -189,6 +298,13 @@ void ChunkedRangeVector::verify() const noexcept
             count += range.second - range.first;
         REALM_ASSERT(count == chunk.count);
     }
+
+    REALM_ASSERT(m_count_tree.size() == m_data.size());
+    size_t count = 0;
+    for (size_t i = 0; i < m_data.size(); ++i) {
+        REALM_ASSERT(count_before(i) == count);
+        count += m_data[i].count;
+    }
 #endif
 }
 
@@ -198,7 +314,6 @@ public:
     using value_type = std::pair<size_t, size_t>;
 
     ChunkedRangeVectorBuilder(ChunkedRangeVector const& expected);
-    void push_back(size_t index);
     void push_back(std::pair<size_t, size_t> range);
     std::vector<ChunkedRangeVector::Chunk> finalize();
 private:
@@ -216,11 +331,6 @@ ChunkedRangeVectorBuilder::ChunkedRangeVectorBuilder(ChunkedRangeVector const& e
         m_data[i].data.reserve(ChunkedRangeVector::max_size);
 }
 
-void ChunkedRangeVectorBuilder::push_back(size_t index)
-{
-    push_back({index, index + 1});
-}
-
 void ChunkedRangeVectorBuilder::push_back(std::pair<size_t, size_t> range)
 {
     auto& chunk = m_data[m_outer_pos];
@@ -241,7 +351,7 @@ void ChunkedRangeVectorBuilder::push_back(std::pair<size_t, size_t> range)
         chunk.end = chunk.data.back().second;
         ++m_outer_pos;
         if (m_outer_pos >= m_data.size())
-            m_data.push_back({{range}, range.first, 0, 1});
+            m_data.push_back({{range}, range.first, 0, range.second - range.first});
         else {
             auto& chunk = m_data[m_outer_pos];
             chunk.data.push_back(range);
@@ -264,6 +374,32 @@ std::vector<ChunkedRangeVector::Chunk> ChunkedRangeVectorBuilder::finalize()
 }
 }
 
+void ChunkedRangeVector::detach_from_arena()
+{
+    ChunkAllocator<value_type> heap(nullptr);
+    for (auto& chunk : m_data) {
+        if (chunk.data.get_allocator().arena())
+            chunk.data = decltype(chunk.data)(chunk.data.begin(), chunk.data.end(), heap);
+    }
+}
+
+size_t ChunkedRangeVector::range_count() const noexcept
+{
+    size_t count = 0;
+    for (auto& chunk : m_data)
+        count += chunk.data.size();
+    return count;
+}
+
+// Check if `a` is so much smaller than `b` that updating `b` in place one index
+// at a time is cheaper than merging the two into a new set. Each in-place update
+// costs a search plus shifting up to a chunk's worth of ranges, while merging
+// copies every range.
+bool IndexSet::is_much_smaller(IndexSet const& a, IndexSet const& b) noexcept
+{
+    return a.count() * 8 < b.range_count();
+}
+
 IndexSet::IndexSet(std::initializer_list<size_t> values)
 {
     for (size_t v : values)
@@ -278,45 +414,23 @@ bool IndexSet::contains(size_t index) const noexcept
 
 size_t IndexSet::count(size_t start_index, size_t end_index) const noexcept
 {
-    auto it = const_cast<IndexSet*>(this)->find(start_index);
-    const auto end = this->end();
-    if (it == end || it->first >= end_index) {
+    if (start_index >= end_index)
         return 0;
-    }
-    if (it->second >= end_index)
-        return std::min(it->second, end_index) - std::max(it->first, start_index);
-
-    size_t ret = 0;
-
-    if (start_index > it->first || it.offset() != 0) {
-        // Start index is in the middle of a chunk, so start by counting the
-        // rest of that chunk
-        ret = it->second - std::max(it->first, start_index);
-        for (++it; it != end && it->second < end_index && it.offset() != 0; ++it) {
-            ret += it->second - it->first;
-        }
-        if (it != end && it->first < end_index && it.offset() != 0)
-            ret += end_index - it->first;
-        if (it == end || it->second >= end_index)
-            return ret;
-    }
-
-    // Now count all complete chunks that fall within the range
-    while (it != end && it.outer()->end <= end_index) {
-        REALM_ASSERT_DEBUG(it.offset() == 0);
-        ret += it.outer()->count;
-        it.next_chunk();
-    }
+    return count_below(end_index) - count_below(start_index);
+}
 
-    // Cound all complete ranges within the last chunk
-    while (it != end && it->second <= end_index) {
-        ret += it->second - it->first;
-        ++it;
+size_t IndexSet::count_below(size_t index) const noexcept
+{
+    auto chunk = std::partition_point(m_data.begin(), m_data.end(),
+                                      [&](auto const& chunk) { return chunk.end <= index; });
+    size_t ret = count_before(chunk - m_data.begin());
+    if (chunk == m_data.end() || chunk->begin >= index)
+        return ret;
+    for (auto range : chunk->data) {
+        if (range.first >= index)
+            break;
+        ret += std::min(range.second, index) - range.first;
     }
-
-    // And finally add in the partial last range
-    if (it != end && it->first < end_index)
-        ret += end_index - it->first;
     return ret;
 }
 
@@ -327,12 +441,13 @@ IndexSet::iterator IndexSet::find(size_t index) noexcept
 
 IndexSet::iterator IndexSet::find(size_t index, iterator begin) noexcept
 {
-    auto it = std::find_if(begin.outer(), m_data.end(),
-                           [&](auto const& lft) { return lft.end > index; });
+    // Chunk ends are strictly increasing, so the chunk can be binary searched for
+    auto it = std::partition_point(begin.outer(), m_data.end(),
+                                   [&](auto const& lft) { return lft.end <= index; });
     if (it == m_data.end())
         return end();
     if (index < it->begin)
-        return iterator(it, m_data.end(), &it->data[0]);
+        return iterator(this, it, m_data.end(), &it->data[0]);
     auto inner_begin = it->data.begin();
     if (it == begin.outer())
         inner_begin += begin.offset();
@@ -340,7 +455,7 @@ IndexSet::iterator IndexSet::find(size_t index, iterator begin) noexcept
                                   [&](auto const& lft, auto) { return lft.second <= index; });
     REALM_ASSERT_DEBUG(inner != it->data.end());
 
-    return iterator(it, m_data.end(), &*inner);
+    return iterator(this, it, m_data.end(), &*inner);
 }
 
 void IndexSet::add(size_t index)
@@ -350,25 +465,66 @@ void IndexSet::add(size_t index)
 
 void IndexSet::add(IndexSet const& other)
 {
-    auto it = begin();
-    for (size_t index : other.as_indexes()) {
-        it = do_add(find(index, it), index);
+    if (other.empty())
+        return;
+    if (empty()) {
+        *this = other;
+        return;
     }
+
+    // Adding a few ranges in place is cheaper than rebuilding the whole set
+    if (is_much_smaller(other, *this)) {
+        auto it = begin();
+        for (auto range : other) {
+            for (size_t index = range.first; index < range.second; ++index)
+                it = do_add(find(index, it), index);
+        }
+        return;
+    }
+
+    ChunkedRangeVectorBuilder builder(*this);
+    auto it1 = cbegin(), end1 = cend();
+    auto it2 = other.cbegin(), end2 = other.cend();
+    value_type current = *it1 < *it2 ? *it1++ : *it2++;
+    while (it1 != end1 || it2 != end2) {
+        auto next = it2 == end2 || (it1 != end1 && it1->first < it2->first) ? *it1++ : *it2++;
+        if (next.first <= current.second) {
+            current.second = std::max(current.second, next.second);
+        }
+        else {
+            builder.push_back(current);
+            current = next;
+        }
+    }
+    builder.push_back(current);
+
+    m_data = builder.finalize();
+    rebuild_count_tree();
 }
 
-size_t IndexSet::add_shifted(size_t index)
+void IndexSet::add(size_t begin, size_t end)
 {
-    iterator it = begin(), end = this->end();
-
-    // Shift for any complete chunks before the target
-    for (; it != end && it.outer()->end <= index; it.next_chunk())
-        index += it.outer()->count;
+    if (begin >= end)
+        return;
 
-    // And any ranges within the last partial chunk
-    for (; it != end && it->first <= index; ++it)
-        index += it->second - it->first;
+    if (empty() || m_data.back().end < begin) {
+        push_back({begin, end});
+    }
+    else if (m_data.back().end == begin) {
+        std::prev(this->end()).adjust(0, end - begin);
+    }
+    else {
+        auto it = this->begin();
+        for (size_t index = begin; index < end; ++index)
+            it = do_add(find(index, it), index);
+    }
+    verify();
+}
 
-    do_add(it, index);
+size_t IndexSet::add_shifted(size_t index)
+{
+    index = shift(index);
+    do_add(find(index), index);
     return index;
 }
 
@@ -393,26 +549,40 @@ void IndexSet::add_shifted_by(IndexSet const& shifted_by, IndexSet const& values
     size_t skip_until = 0;
     size_t old_shift = 0;
     size_t new_shift = 0;
-    for (size_t index : values.as_indexes()) {
-        for (; shift_it != shift_end && shift_it->first <= index; ++shift_it) {
-            new_shift += shift_it->second - shift_it->first;
-            skip_until = shift_it->second;
-        }
-        if (index < skip_until)
-            continue;
-
-        for (; old_it != old_end && old_it->first <= index - new_shift + old_shift; ++old_it) {
-            for (size_t i = old_it->first; i < old_it->second; ++i)
-                builder.push_back(i);
-            old_shift += old_it->second - old_it->first;
+    for (auto range : values) {
+        // Each pass through this loop handles the longest run of indexes at
+        // the front of the range which are all shifted by the same amount
+        for (size_t index = range.first; index < range.second; ) {
+            for (; shift_it != shift_end && shift_it->first <= index; ++shift_it) {
+                new_shift += shift_it->second - shift_it->first;
+                skip_until = shift_it->second;
+            }
+            if (index < skip_until) {
+                index = std::min(skip_until, range.second);
+                continue;
+            }
+
+            REALM_ASSERT(index >= new_shift);
+            size_t target = index - new_shift + old_shift;
+            for (; old_it != old_end && old_it->first <= target; ++old_it) {
+                builder.push_back(*old_it);
+                old_shift += old_it->second - old_it->first;
+                target = index - new_shift + old_shift;
+            }
+
+            size_t run_end = range.second;
+            if (shift_it != shift_end)
+                run_end = std::min(run_end, shift_it->first);
+            if (old_it != old_end)
+                run_end = std::min(run_end, index + (old_it->first - target));
+            builder.push_back({target, target + (run_end - index)});
+            index = run_end;
         }
-
-        REALM_ASSERT(index >= new_shift);
-        builder.push_back(index - new_shift + old_shift);
     }
 
     copy(old_it, old_end, std::back_inserter(builder));
     m_data = builder.finalize();
+    rebuild_count_tree();
 
 #ifdef REALM_DEBUG
     REALM_ASSERT((size_t)std::distance(as_indexes().begin(), as_indexes().end()) == expected);
@@ -453,6 +623,46 @@ void IndexSet::insert_at(size_t index, size_t count)
     verify();
 }
 
+template<typename Builder>
+void IndexSet::shift_ranges_for_insert_at(Builder& builder, IndexSet const& positions, bool insert) const
+{
+    auto it1 = cbegin(), end1 = cend();
+    auto it2 = positions.cbegin(), end2 = positions.cend();
+
+    // The part of the current range which hasn't been handled yet, unshifted
+    value_type current = *it1;
+    size_t shift = 0;
+    while (it2 != end2) {
+        if (current.first + shift < it2->first) {
+            // Copy over everything which ends up before the next inserted range
+            size_t count = std::min(current.second - current.first, it2->first - current.first - shift);
+            builder.push_back({current.first + shift, current.first + shift + count});
+            current.first += count;
+            if (current.first == current.second) {
+                if (++it1 == end1)
+                    break;
+                current = *it1;
+            }
+        }
+        else {
+            // Everything from here on is pushed back by the inserted range
+            if (insert)
+                builder.push_back(*it2);
+            shift += it2->second - it2->first;
+            ++it2;
+        }
+    }
+    if (it1 != end1) {
+        builder.push_back({current.first + shift, current.second + shift});
+        for (++it1; it1 != end1; ++it1)
+            builder.push_back({it1->first + shift, it1->second + shift});
+    }
+    if (insert) {
+        for (; it2 != end2; ++it2)
+            builder.push_back(*it2);
+    }
+}
+
 void IndexSet::insert_at(IndexSet const& positions)
 {
     if (positions.empty())
@@ -462,26 +672,10 @@ void IndexSet::insert_at(IndexSet const& positions)
         return;
     }
 
-    IndexIterator begin1 = cbegin(), begin2 = positions.cbegin();
-    IndexIterator end1 = cend(), end2 = positions.cend();
-
     ChunkedRangeVectorBuilder builder(*this);
-    size_t shift = 0;
-    while (begin1 != end1 && begin2 != end2) {
-        if (*begin1 + shift < *begin2) {
-            builder.push_back(*begin1++ + shift);
-        }
-        else {
-            ++shift;
-            builder.push_back(*begin2++);
-        }
-    }
-    for (; begin1 != end1; ++begin1)
-        builder.push_back(*begin1 + shift);
-    for (; begin2 != end2; ++begin2)
-        builder.push_back(*begin2);
-
+    shift_ranges_for_insert_at(builder, positions, true);
     m_data = builder.finalize();
+    rebuild_count_tree();
 }
 
 void IndexSet::shift_for_insert_at(size_t index, size_t count)
@@ -512,24 +706,10 @@ void IndexSet::shift_for_insert_at(realm::IndexSet const& values)
     if (values.m_data.front().begin >= m_data.back().end)
         return;
 
-    IndexIterator begin1 = cbegin(), begin2 = values.cbegin();
-    IndexIterator end1 = cend(), end2 = values.cend();
-
     ChunkedRangeVectorBuilder builder(*this);
-    size_t shift = 0;
-    while (begin1 != end1 && begin2 != end2) {
-        if (*begin1 + shift < *begin2) {
-            builder.push_back(*begin1++ + shift);
-        }
-        else {
-            ++shift;
-            begin2++;
-        }
-    }
-    for (; begin1 != end1; ++begin1)
-        builder.push_back(*begin1 + shift);
-
+    shift_ranges_for_insert_at(builder, values, false);
     m_data = builder.finalize();
+    rebuild_count_tree();
 }
 
 void IndexSet::erase_at(size_t index)
@@ -546,28 +726,44 @@ void IndexSet::erase_at(IndexSet const& positions)
 
     ChunkedRangeVectorBuilder builder(*this);
 
-    IndexIterator begin1 = cbegin(), begin2 = positions.cbegin();
-    IndexIterator end1 = cend(), end2 = positions.cend();
+    auto it1 = cbegin(), end1 = cend();
+    auto it2 = positions.cbegin(), end2 = positions.cend();
 
+    // The part of the current range which hasn't been handled yet
+    value_type current = *it1;
     size_t shift = 0;
-    while (begin1 != end1 && begin2 != end2) {
-        if (*begin1 < *begin2) {
-            builder.push_back(*begin1++ - shift);
+    while (it2 != end2) {
+        if (current.first < it2->first) {
+            // Copy over everything before the next erased range
+            size_t end = std::min(current.second, it2->first);
+            builder.push_back({current.first - shift, end - shift});
+            current.first = end;
         }
-        else if (*begin1 == *begin2) {
-            ++shift;
-            ++begin1;
-            ++begin2;
+        else if (current.first >= it2->second) {
+            // Passed the erased range, so everything after it moves back
+            shift += it2->second - it2->first;
+            ++it2;
+            continue;
         }
         else {
-            ++shift;
-            ++begin2;
+            // Drop the part of the range which was erased
+            current.first = std::min(current.second, it2->second);
+        }
+
+        if (current.first == current.second) {
+            if (++it1 == end1)
+                break;
+            current = *it1;
         }
     }
-    for (; begin1 != end1; ++begin1)
-        builder.push_back(*begin1 - shift);
+    if (it1 != end1) {
+        builder.push_back({current.first - shift, current.second - shift});
+        for (++it1; it1 != end1; ++it1)
+            builder.push_back({it1->first - shift, it1->second - shift});
+    }
 
     m_data = builder.finalize();
+    rebuild_count_tree();
 }
 
 size_t IndexSet::erase_or_unshift(size_t index)
@@ -645,18 +841,62 @@ void IndexSet::remove(size_t index, size_t count)
 
 void IndexSet::remove(realm::IndexSet const& values)
 {
-    auto it = begin();
-    for (auto range : values) {
-        it = do_remove(it, range.first, range.second);
-        if (it == end())
-            return;
+    if (empty() || values.empty())
+        return;
+
+    // Removing a few ranges in place is cheaper than rebuilding the whole set
+    if (is_much_smaller(values, *this)) {
+        auto it = begin();
+        for (auto range : values) {
+            it = do_remove(it, range.first, range.second);
+            if (it == end())
+                return;
+        }
+        return;
+    }
+
+    ChunkedRangeVectorBuilder builder(*this);
+    auto removed = values.cbegin(), removed_end = values.cend();
+    for (auto range : *this) {
+        size_t first = range.first;
+        for (; removed != removed_end && removed->second <= first; ++removed)
+            ;
+        // A removed range may also overlap the next range, so this only skips
+        // past the ones which end before the start of the range
+        for (auto it = removed; it != removed_end && it->first < range.second; ++it) {
+            if (it->first > first)
+                builder.push_back({first, it->first});
+            first = std::max(first, it->second);
+            if (first >= range.second)
+                break;
+        }
+        if (first < range.second)
+            builder.push_back({first, range.second});
     }
+
+    m_data = builder.finalize();
+    rebuild_count_tree();
 }
 
 size_t IndexSet::shift(size_t index) const noexcept
 {
-    // FIXME: optimize
-    for (auto range : *this) {
+    // Find the last chunk whose first range is at or before the index once
+    // it's been shifted by all of the chunks before it. A chunk's begin minus
+    // the count before it is strictly increasing, so this can be a binary
+    // search, and every chunk before that one shifts the index by its count.
+    size_t low = 0, high = m_data.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (m_data[mid].begin - count_before(mid) <= index)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low == 0)
+        return index;
+
+    index += count_before(low - 1);
+    for (auto range : m_data[low - 1].data) {
         if (range.first > index)
             break;
         index += range.second - range.first;
@@ -673,6 +913,7 @@ size_t IndexSet::unshift(size_t index) const noexcept
 void IndexSet::clear() noexcept
 {
     m_data.clear();
+    m_count_tree.clear();
 }
 
 IndexSet::iterator IndexSet::do_add(iterator it, size_t index)
@@ -22,12 +22,102 @@
 #include <cstddef>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace realm {
 namespace _impl {
+struct ChunkedRangeVector;
+
+// A monotonic arena which the storage for ChunkedRangeVectors (and the hash
+// tables of ObjectChangeSets) can be allocated from, so that many short-lived
+// changesets can be freed at once rather than one allocation at a time. The
+// storage for any vector created on a thread while a Scope is active on that
+// thread comes from the scope's arena, and so the vector must be destroyed or
+// detached from the arena before the arena is.
+class ChunkArena {
+public:
+    ChunkArena() = default;
+    ChunkArena(ChunkArena&&) = default;
+    ChunkArena& operator=(ChunkArena&&) = default;
+
+    void* allocate(size_t size);
+
+    // Free everything allocated from the arena
+    void reset() noexcept;
+
+    // The total number of bytes handed out by allocate() since the last reset
+    size_t bytes_allocated() const noexcept { return m_bytes_allocated; }
+
+    // The arena used by allocations on the current thread, if any
+    static ChunkArena* current() noexcept;
+
+    class Scope {
+    public:
+        Scope(ChunkArena& arena) noexcept;
+        // Allocate from the heap while the scope is active, for objects which
+        // have to outlive the arena of an enclosing scope
+        Scope(std::nullptr_t) noexcept;
+        ~Scope();
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+    private:
+        ChunkArena* m_previous;
+    };
+
+private:
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char* m_next = nullptr;
+    size_t m_remaining = 0;
+    size_t m_bytes_allocated = 0;
+};
+
+// An allocator which allocates from the ChunkArena which was current when it
+// was created, or from the heap if there wasn't one. Moving or swapping a
+// container brings its allocator along, while copying a container uses the
+// arena current at the time of the copy.
+template<typename T>
+class ChunkAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ChunkAllocator() noexcept : m_arena(ChunkArena::current()) { }
+    explicit ChunkAllocator(ChunkArena* arena) noexcept : m_arena(arena) { }
+    template<typename U>
+    ChunkAllocator(ChunkAllocator<U> const& other) noexcept : m_arena(other.arena()) { }
+
+    T* allocate(size_t n)
+    {
+        if (m_arena)
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t) noexcept
+    {
+        // Arena allocations are all freed together when the arena is reset
+        if (!m_arena)
+            ::operator delete(ptr);
+    }
+
+    ChunkAllocator select_on_container_copy_construction() const noexcept { return {}; }
+
+    ChunkArena* arena() const noexcept { return m_arena; }
+
+    template<typename U>
+    bool operator==(ChunkAllocator<U> const& other) const noexcept { return m_arena == other.arena(); }
+    template<typename U>
+    bool operator!=(ChunkAllocator<U> const& other) const noexcept { return m_arena != other.arena(); }
+
+private:
+    ChunkArena* m_arena;
+};
 template<typename OuterIterator>
 class MutableChunkedRangeVectorIterator;
 
@@ -74,7 +164,11 @@ private:
 template<typename OuterIterator>
 class MutableChunkedRangeVectorIterator : public ChunkedRangeVectorIterator<OuterIterator> {
 public:
-    using ChunkedRangeVectorIterator<OuterIterator>::ChunkedRangeVectorIterator;
+    using value_type = typename ChunkedRangeVectorIterator<OuterIterator>::value_type;
+
+    MutableChunkedRangeVectorIterator(ChunkedRangeVector* parent, OuterIterator outer, OuterIterator end,
+                                      value_type* inner)
+    : ChunkedRangeVectorIterator<OuterIterator>(outer, end, inner), m_parent(parent) { }
 
     // Set this iterator to the given range and update the parent if needed
     void set(size_t begin, size_t end);
@@ -83,17 +177,25 @@ public:
     void adjust(ptrdiff_t front, ptrdiff_t back);
     // Shift this iterator by the given amount and update the parent if needed
     void shift(ptrdiff_t distance);
+
+private:
+    ChunkedRangeVector* m_parent;
 };
 
 // A vector which stores ranges in chunks with a maximum size
 struct ChunkedRangeVector {
     struct Chunk {
-        std::vector<std::pair<size_t, size_t>> data;
+        std::vector<std::pair<size_t, size_t>, ChunkAllocator<std::pair<size_t, size_t>>> data;
         size_t begin;
         size_t end;
         size_t count;
     };
     std::vector<Chunk> m_data;
+    // A Fenwick tree over the `count` of each chunk in m_data, so that the
+    // number of indices before a given chunk can be found in O(log n). Updated
+    // whenever a chunk's count changes and rebuilt whenever chunks are added
+    // or removed other than at the end.
+    std::vector<size_t> m_count_tree;
 
     using value_type = std::pair<size_t, size_t>;
     using iterator = MutableChunkedRangeVectorIterator<typename decltype(m_data)::iterator>;
@@ -105,8 +207,8 @@ struct ChunkedRangeVector {
     static const size_t max_size = 4096 / sizeof(std::pair<size_t, size_t>);
 #endif
 
-    iterator begin() noexcept { return empty() ? end() : iterator(m_data.begin(), m_data.end(), &m_data[0].data[0]); }
-    iterator end() noexcept { return iterator(m_data.end(), m_data.end(), nullptr); }
+    iterator begin() noexcept { return empty() ? end() : iterator(this, m_data.begin(), m_data.end(), &m_data[0].data[0]); }
+    iterator end() noexcept { return iterator(this, m_data.end(), m_data.end(), nullptr); }
     const_iterator begin() const noexcept { return cbegin(); }
     const_iterator end() const noexcept { return cend(); }
     const_iterator cbegin() const noexcept { return empty() ? cend() : const_iterator(m_data.cbegin(), m_data.end(), &m_data[0].data[0]); }
@@ -119,6 +221,20 @@ struct ChunkedRangeVector {
     void push_back(value_type value);
     iterator ensure_space(iterator pos);
 
+    // The total count of the chunks before the given one
+    size_t count_before(size_t chunk_index) const noexcept;
+    // Update m_count_tree after the count of the given chunk changed by `delta`
+    void chunk_count_changed(size_t chunk_index, ptrdiff_t delta) noexcept;
+    // Rebuild m_count_tree after m_data was modified
+    void rebuild_count_tree();
+
+    // The total number of ranges in all chunks
+    size_t range_count() const noexcept;
+
+    // Move any chunks allocated from a ChunkArena to the heap, so that this
+    // can outlive the arena
+    void detach_from_arena();
+
     void verify() const noexcept;
 };
 } // namespace _impl
@@ -134,6 +250,7 @@ public:
     using ChunkedRangeVector::end;
     using ChunkedRangeVector::empty;
     using ChunkedRangeVector::verify;
+    using ChunkedRangeVector::detach_from_arena;
 
     IndexSet() = default;
     IndexSet(std::initializer_list<size_t>);
@@ -147,6 +264,9 @@ public:
     // Add an index to the set, doing nothing if it's already present
     void add(size_t index);
     void add(IndexSet const& is);
+    // Add all of the indexes in [begin, end). This is much cheaper than adding
+    // them one at a time when the range is after every index in the set.
+    void add(size_t begin, size_t end);
 
     // Add an index which has had all of the ranges in the set before it removed
     // Returns the unshifted index
@@ -247,6 +367,17 @@ private:
     iterator do_remove(iterator it, size_t index, size_t count);
 
     void shift_until_end_by(iterator begin, ptrdiff_t shift);
+
+    // The number of indexes in the set which are less than `index`
+    size_t count_below(size_t index) const noexcept;
+
+    // Write the ranges of this set to `builder` shifted for an insertion at
+    // each of the given positions, along with the positions themselves if
+    // `insert` is true
+    template<typename Builder>
+    void shift_ranges_for_insert_at(Builder& builder, IndexSet const& positions, bool insert) const;
+
+    static bool is_much_smaller(IndexSet const& a, IndexSet const& b) noexcept;
 };
 
 namespace util {
@@ -16,6 +16,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////
 
+#include "collection_notifications.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
 #include "shared_realm.hpp"
@@ -24,7 +25,7 @@
 
 namespace realm {
 /// Populate the mapping from public name to internal name for queries.
-static void populate_keypath_mapping(parser::KeyPathMapping& mapping, Realm& realm)
+inline void populate_keypath_mapping(parser::KeyPathMapping& mapping, Realm& realm)
 {
     mapping.set_backlink_class_prefix("class_");
 
@@ -103,4 +104,47 @@ inline IncludeDescriptor generate_include_from_keypaths(std::vector<StringData>
     }
     return IncludeDescriptor{base_table, properties};
 }
+
+/// Generate a KeyPathArray for filtering change notifications from a list of key paths.
+///
+/// Each key path in the list is a period ('.') separated property path, beginning
+/// at the class defined by `object_schema`, where every property other than the
+/// last is a link to another object.
+inline KeyPathArray generate_key_path_array(std::vector<std::string> const& paths, Realm& realm,
+                                            ObjectSchema const& object_schema)
+{
+    KeyPathArray key_path_array;
+    for (auto& path : paths) {
+        if (path.empty()) {
+            throw InvalidPathError("missing property name while generating notification key paths");
+        }
+
+        std::vector<std::pair<TableKey, ColKey>> key_path;
+        ObjectSchema const* schema = &object_schema;
+        size_t begin = 0;
+        while (true) {
+            size_t end = path.find('.', begin);
+            auto name = path.substr(begin, end == std::string::npos ? end : end - begin);
+            auto property = schema->property_for_public_name(name);
+            if (!property)
+                property = schema->property_for_name(name);
+            if (!property || (property->type & ~PropertyType::Flags) == PropertyType::LinkingObjects) {
+                throw InvalidPathError(util::format("Property '%1' does not exist on object of type '%2' in key path '%3'",
+                                                    name, schema->name, path));
+            }
+            key_path.emplace_back(schema->table_key, property->column_key);
+            if (end == std::string::npos)
+                break;
+
+            if ((property->type & ~PropertyType::Flags) != PropertyType::Object) {
+                throw InvalidPathError(util::format("Property '%1' is not a link in object of type '%2' in key path '%3'",
+                                                    name, schema->name, path));
+            }
+            schema = &*realm.schema().find(property->object_type);
+            begin = end + 1;
+        }
+        key_path_array.push_back(std::move(key_path));
+    }
+    return key_path_array;
+}
 }
@@ -430,7 +430,14 @@ bool List::operator==(List const& rgt) const noexcept
         && m_list_base->get_col_key() == rgt.m_list_base->get_col_key();
 }
 
-NotificationToken List::add_notification_callback(CollectionChangeCallback cb) &
+NotificationToken List::add_notification_callback(CollectionChangeCallback cb,
+                                                  std::chrono::milliseconds min_delivery_interval) &
+{
+    return add_notification_callback(std::move(cb), {}, min_delivery_interval);
+}
+
+NotificationToken List::add_notification_callback(CollectionChangeCallback cb, KeyPathArray key_path_array,
+                                                  std::chrono::milliseconds min_delivery_interval) &
 {
     verify_attached();
     m_realm->verify_notifications_available();
@@ -443,10 +450,10 @@ NotificationToken List::add_notification_callback(CollectionChangeCallback cb) &
     if (m_notifier && !m_notifier->have_callbacks())
         m_notifier.reset();
     if (!m_notifier) {
-        m_notifier = std::make_shared<ListNotifier>(m_realm, *m_list_base, m_type);
-        RealmCoordinator::register_notifier(m_notifier);
+        auto notifier = std::make_shared<ListNotifier>(m_realm, *m_list_base, m_type);
+        m_notifier = std::static_pointer_cast<ListNotifier>(RealmCoordinator::register_notifier(std::move(notifier)));
     }
-    return {m_notifier, m_notifier->add_callback(std::move(cb))};
+    return {m_notifier, m_notifier.add_callback(std::move(cb), min_delivery_interval, std::move(key_path_array))};
 }
 
 List List::freeze(std::shared_ptr<Realm> const& frozen_realm) const
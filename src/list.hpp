@@ -128,7 +128,11 @@ public:
 
     bool operator==(List const& rgt) const noexcept;
 
-    NotificationToken add_notification_callback(CollectionChangeCallback cb) &;
+    // See Results::add_notification_callback()
+    NotificationToken add_notification_callback(CollectionChangeCallback cb,
+                                                std::chrono::milliseconds min_delivery_interval={}) &;
+    NotificationToken add_notification_callback(CollectionChangeCallback cb, KeyPathArray key_path_array,
+                                                std::chrono::milliseconds min_delivery_interval={}) &;
 
     template<typename Context>
     auto get(Context&, size_t row_ndx) const;
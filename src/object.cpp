@@ -96,15 +96,23 @@ Object::Object(Object&&) = default;
 Object& Object::operator=(Object const&) = default;
 Object& Object::operator=(Object&&) = default;
 
-NotificationToken Object::add_notification_callback(CollectionChangeCallback callback) &
+NotificationToken Object::add_notification_callback(CollectionChangeCallback callback,
+                                                    std::chrono::milliseconds min_delivery_interval) &
+{
+    return add_notification_callback(std::move(callback), {}, min_delivery_interval);
+}
+
+NotificationToken Object::add_notification_callback(CollectionChangeCallback callback, KeyPathArray key_path_array,
+                                                    std::chrono::milliseconds min_delivery_interval) &
 {
     verify_attached();
     m_realm->verify_notifications_available();
     if (!m_notifier) {
-        m_notifier = std::make_shared<_impl::ObjectNotifier>(m_realm, m_obj.get_table()->get_key(), m_obj.get_key());
-        _impl::RealmCoordinator::register_notifier(m_notifier);
+        auto notifier = std::make_shared<_impl::ObjectNotifier>(m_realm, m_obj.get_table(), m_obj.get_key());
+        m_notifier = std::static_pointer_cast<_impl::ObjectNotifier>(_impl::RealmCoordinator::register_notifier(std::move(notifier)));
     }
-    return {m_notifier, m_notifier->add_callback(std::move(callback))};
+    return {m_notifier, m_notifier.add_callback(std::move(callback), min_delivery_interval,
+                                                std::move(key_path_array))};
 }
 
 void Object::verify_attached() const
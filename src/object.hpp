@@ -71,7 +71,13 @@ public:
     // Returns whether or not this Object is frozen.
     bool is_frozen() const noexcept;
 
-    NotificationToken add_notification_callback(CollectionChangeCallback callback) &;
+    // See Results::add_notification_callback()
+    NotificationToken add_notification_callback(CollectionChangeCallback callback,
+                                                std::chrono::milliseconds min_delivery_interval={}) &;
+    // Key paths which follow a link report the change as a modification of
+    // the link property
+    NotificationToken add_notification_callback(CollectionChangeCallback callback, KeyPathArray key_path_array,
+                                                std::chrono::milliseconds min_delivery_interval={}) &;
 
     void ensure_user_in_everyone_role();
     void ensure_private_role_exists_for_user();
@@ -18,8 +18,95 @@
 
 #include "object_changeset.hpp"
 
+#include <algorithm>
+
 using namespace realm;
 
+constexpr uint64_t ObjectChangeSet::overflow_bit;
+constexpr size_t ObjectChangeSet::max_mask_columns;
+
+ObjectChangeSet::ColumnSet::iterator::iterator(ColumnSet const& set, uint64_t bits, size_t overflow_ndx) noexcept
+: m_set(&set), m_bits(bits), m_overflow_ndx(overflow_ndx)
+{
+    skip_unset();
+}
+
+void ObjectChangeSet::ColumnSet::iterator::skip_unset() noexcept
+{
+    if (!m_bits) {
+        m_pos = 0;
+        return;
+    }
+    while (!(m_bits & 1)) {
+        m_bits >>= 1;
+        ++m_pos;
+    }
+}
+
+auto ObjectChangeSet::ColumnSet::iterator::operator*() const noexcept -> reference
+{
+    if (m_bits)
+        return (*m_set->m_columns)[m_pos];
+    return (*m_set->m_overflow)[m_overflow_ndx];
+}
+
+bool ObjectChangeSet::ColumnSet::iterator::operator==(iterator const& other) const noexcept
+{
+    return m_bits == other.m_bits && m_pos == other.m_pos && m_overflow_ndx == other.m_overflow_ndx;
+}
+
+auto ObjectChangeSet::ColumnSet::iterator::operator++() noexcept -> iterator&
+{
+    if (m_bits) {
+        m_bits >>= 1;
+        ++m_pos;
+        skip_unset();
+    }
+    else {
+        ++m_overflow_ndx;
+    }
+    return *this;
+}
+
+bool ObjectChangeSet::ColumnSet::contains(ColKeyType col) const noexcept
+{
+    if (!m_mask)
+        return false;
+    for (size_t i = 0; i < m_columns->size(); ++i) {
+        if ((*m_columns)[i] == col)
+            return (m_mask >> i) & 1;
+    }
+    return m_overflow && std::find(m_overflow->begin(), m_overflow->end(), col) != m_overflow->end();
+}
+
+size_t ObjectChangeSet::ColumnSet::size() const noexcept
+{
+    size_t count = m_overflow ? m_overflow->size() : 0;
+    for (uint64_t bits = m_mask & ~overflow_bit; bits; bits &= bits - 1)
+        ++count;
+    return count;
+}
+
+ObjectChangeSet::ObjectMapToColumnSet::iterator::iterator(ObjectChangeSet const& changes,
+                                                          ModificationMap::const_iterator pos) noexcept
+: m_changes(&changes), m_pos(pos)
+{
+    load();
+}
+
+auto ObjectChangeSet::ObjectMapToColumnSet::iterator::operator++() noexcept -> iterator&
+{
+    ++m_pos;
+    load();
+    return *this;
+}
+
+void ObjectChangeSet::ObjectMapToColumnSet::iterator::load() noexcept
+{
+    if (m_pos != m_changes->m_modifications.end())
+        m_value = {m_pos->first, m_changes->column_set(m_pos->first, m_pos->second)};
+}
+
 void ObjectChangeSet::insertions_add(ObjectKeyType obj)
 {
     m_insertions.insert(obj);
@@ -28,16 +115,51 @@ void ObjectChangeSet::insertions_add(ObjectKeyType obj)
 void ObjectChangeSet::modifications_add(ObjectKeyType obj, ColKeyType col)
 {
     // don't report modifications on new objects
-    if (m_insertions.find(obj) == m_insertions.end()) {
-        m_modifications[obj].insert(col);
+    if (!m_insertions.contains(obj)) {
+        add_column(m_modifications.insert(obj).first->second, obj, col);
     }
 }
 
-void ObjectChangeSet::deletions_add(ObjectKeyType obj)
+uint64_t ObjectChangeSet::column_bit(ColKeyType col)
+{
+    // Most transactions modify only a handful of columns in each table, so a
+    // linear search is faster than anything more clever
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        if (m_columns[i] == col)
+            return uint64_t(1) << i;
+    }
+    if (m_columns.size() == max_mask_columns)
+        return overflow_bit;
+    m_columns.push_back(col);
+    return uint64_t(1) << (m_columns.size() - 1);
+}
+
+void ObjectChangeSet::add_column(uint64_t& mask, ObjectKeyType obj, ColKeyType col)
+{
+    uint64_t bit = column_bit(col);
+    mask |= bit;
+    if (bit == overflow_bit) {
+        auto& columns = m_overflow_columns[obj];
+        if (std::find(columns.begin(), columns.end(), col) == columns.end())
+            columns.push_back(col);
+    }
+}
+
+bool ObjectChangeSet::erase_modification(ObjectKeyType obj)
 {
+    auto entry = m_modifications.find(obj);
+    if (!entry)
+        return false;
+    if (entry->second & overflow_bit)
+        m_overflow_columns.erase(obj);
     m_modifications.erase(obj);
-    size_t num_inserts_removed = m_insertions.erase(obj);
-    if (num_inserts_removed == 0) {
+    return true;
+}
+
+void ObjectChangeSet::deletions_add(ObjectKeyType obj)
+{
+    erase_modification(obj);
+    if (!m_insertions.erase(obj)) {
         m_deletions.insert(obj);
     }
 }
@@ -49,21 +171,23 @@ void ObjectChangeSet::clear(size_t old_size)
     m_insertions.clear();
     m_modifications.clear();
     m_deletions.clear();
+    m_columns.clear();
+    m_overflow_columns.clear();
 }
 
 bool ObjectChangeSet::insertions_remove(ObjectKeyType obj)
 {
-    return m_insertions.erase(obj) > 0;
+    return m_insertions.erase(obj);
 }
 
 bool ObjectChangeSet::modifications_remove(ObjectKeyType obj)
 {
-    return m_modifications.erase(obj) > 0;
+    return erase_modification(obj);
 }
 
 bool ObjectChangeSet::deletions_remove(ObjectKeyType obj)
 {
-    return m_deletions.erase(obj) > 0;
+    return m_deletions.erase(obj);
 }
 
 bool ObjectChangeSet::deletions_contains(ObjectKeyType obj) const
@@ -71,28 +195,57 @@ bool ObjectChangeSet::deletions_contains(ObjectKeyType obj) const
     if (m_clear_did_occur) {
         // FIXME: what are the expected notifications when an object is deleted
         // and then another object is inserted with the same key?
-        return m_insertions.count(obj) == 0;
+        return !m_insertions.contains(obj);
     }
-    return m_deletions.count(obj) > 0;
+    return m_deletions.contains(obj);
 }
 
 bool ObjectChangeSet::insertions_contains(ObjectKeyType obj) const
 {
-    return m_insertions.count(obj) > 0;
+    return m_insertions.contains(obj);
 }
 
 bool ObjectChangeSet::modifications_contains(ObjectKeyType obj) const
 {
-    return m_modifications.count(obj) > 0;
+    return m_modifications.contains(obj);
 }
 
-const ObjectChangeSet::ObjectSet* ObjectChangeSet::get_columns_modified(ObjectKeyType obj) const
+bool ObjectChangeSet::modifications_contains(ObjectKeyType obj,
+                                             std::vector<ColKeyType> const& filtered_column_keys) const
 {
-    auto it = m_modifications.find(obj);
-    if (it == m_modifications.end()) {
-        return nullptr;
+    if (filtered_column_keys.empty())
+        return modifications_contains(obj);
+    auto columns = get_columns_modified(obj);
+    if (!columns)
+        return false;
+    return std::any_of(filtered_column_keys.begin(), filtered_column_keys.end(),
+                       [&](ColKeyType col) { return columns->contains(col); });
+}
+
+util::Optional<ObjectChangeSet::ColumnSet> ObjectChangeSet::get_columns_modified(ObjectKeyType obj) const
+{
+    auto entry = m_modifications.find(obj);
+    if (!entry) {
+        return util::none;
     }
-    return &it->second;
+    return column_set(obj, entry->second);
+}
+
+ObjectChangeSet::ColumnSet ObjectChangeSet::column_set(ObjectKeyType obj, uint64_t mask) const
+{
+    std::vector<ColKeyType> const* overflow = nullptr;
+    if (mask & overflow_bit)
+        overflow = &m_overflow_columns.at(obj);
+    return ColumnSet(mask, &m_columns, overflow);
+}
+
+size_t ObjectChangeSet::memory_usage() const noexcept
+{
+    size_t size = m_deletions.memory_usage() + m_insertions.memory_usage() + m_modifications.memory_usage();
+    size += m_columns.capacity() * sizeof(ColKeyType);
+    for (auto& columns : m_overflow_columns)
+        size += sizeof(columns) + columns.second.capacity() * sizeof(ColKeyType);
+    return size;
 }
 
 void ObjectChangeSet::merge(ObjectChangeSet&& other)
@@ -101,6 +254,19 @@ void ObjectChangeSet::merge(ObjectChangeSet&& other)
         return;
     if (empty()) {
         *this = std::move(other);
+        other = {};
+        return;
+    }
+    merge(static_cast<ObjectChangeSet const&>(other));
+    other = {};
+}
+
+void ObjectChangeSet::merge(ObjectChangeSet const& other)
+{
+    if (other.empty())
+        return;
+    if (empty()) {
+        *this = other;
         return;
     }
     m_clear_did_occur = m_clear_did_occur || other.m_clear_did_occur;
@@ -109,41 +275,57 @@ void ObjectChangeSet::merge(ObjectChangeSet&& other)
     other.verify();
 
     // Drop any inserted-then-deleted rows, then merge in new insertions
-    for (auto it = other.m_deletions.begin(); it != other.m_deletions.end();) {
-        auto previously_inserted = m_insertions.find(*it);
-        auto previously_modified = m_modifications.find(*it);
-        if (previously_modified != m_modifications.end()) {
-            m_modifications.erase(previously_modified);
-        }
-        if (previously_inserted != m_insertions.end()) {
-            m_insertions.erase(previously_inserted);
-            it = m_deletions.erase(it);
-        }
-        else {
-            ++it;
-        }
+    for (auto obj : other.m_deletions) {
+        erase_modification(obj);
+        if (!m_insertions.erase(obj))
+            m_deletions.insert(obj);
     }
     if (!other.m_insertions.empty()) {
-        m_insertions.insert(other.m_insertions.begin(), other.m_insertions.end());
-    }
-    if (!other.m_deletions.empty()) {
-        m_deletions.insert(other.m_deletions.begin(), other.m_deletions.end());
+        m_insertions.reserve(m_insertions.size() + other.m_insertions.size());
+        for (auto obj : other.m_insertions)
+            m_insertions.insert(obj);
     }
-    for (auto it = other.m_modifications.begin(); it != other.m_modifications.end(); ++it) {
-        m_modifications[it->first].insert(it->second.begin(), it->second.end());
+
+    if (!other.m_modifications.empty()) {
+        // Translate the bits of the other changeset's masks to ours once up
+        // front rather than looking up the columns for each object
+        uint64_t translated[max_mask_columns];
+        for (size_t i = 0; i < other.m_columns.size(); ++i)
+            translated[i] = column_bit(other.m_columns[i]);
+
+        m_modifications.reserve(m_modifications.size() + other.m_modifications.size());
+        for (auto& modification : other.m_modifications) {
+            auto obj = modification.first;
+            auto& mask = m_modifications.insert(obj).first->second;
+            uint64_t bits = modification.second & ~overflow_bit;
+            for (size_t i = 0; bits; ++i, bits >>= 1) {
+                if (!(bits & 1))
+                    continue;
+                if (translated[i] == overflow_bit)
+                    add_column(mask, obj, other.m_columns[i]);
+                else
+                    mask |= translated[i];
+            }
+            if (modification.second & overflow_bit) {
+                for (auto col : other.m_overflow_columns.at(obj))
+                    add_column(mask, obj, col);
+            }
+        }
     }
 
     verify();
-
-    other = {};
 }
 
-void ObjectChangeSet::verify()
+void ObjectChangeSet::verify() const
 {
 #ifdef REALM_DEBUG
-    for (auto it = m_deletions.begin(); it != m_deletions.end(); ++it) {
-        REALM_ASSERT_EX(m_insertions.find(*it) == m_insertions.end(), *it);
+    for (auto obj : m_deletions) {
+        REALM_ASSERT_EX(!m_insertions.contains(obj), obj);
+    }
+    for (auto& modification : m_modifications) {
+        REALM_ASSERT_EX(modification.second != 0, modification.first);
+        REALM_ASSERT_EX(bool(modification.second & overflow_bit) == bool(m_overflow_columns.count(modification.first)),
+                        modification.first);
     }
 #endif
 }
-
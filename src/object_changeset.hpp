@@ -20,22 +20,142 @@
 #define REALM_OBJECT_CHANGESET_HPP
 
 #include "collection_notifications.hpp"
+#include "impl/object_key_table.hpp"
 
 #include <realm/keys.hpp>
 #include <realm/util/optional.hpp>
 
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace realm {
 
+// The objects inserted, deleted and modified in a single table.
+//
+// A large write transaction can touch millions of objects, so rather than
+// allocating a node for each object and another for each of its modified
+// columns, the changed objects are kept in flat open-addressing hash tables
+// and the modified columns of each object are a bitmask. Each bit refers to
+// an entry in the table-wide list of modified columns, with the last bit
+// reserved for objects with modified columns past the 63rd distinct column
+// in the table, which are stored separately.
 class ObjectChangeSet {
+    // The mask of modified columns for each modified object
+    using ModificationMap = _impl::ObjectKeyMap<uint64_t>;
+
 public:
     using ColKeyType = decltype(realm::ColKey::value);
     using ObjectKeyType = decltype(realm::ObjKey::value);
-    using ObjectSet = std::unordered_set<ObjectKeyType>;
-    using ObjectMapToColumnSet = std::unordered_map<ObjectKeyType, std::unordered_set<ColKeyType>>;
+    using ObjectSet = _impl::ObjectKeySet;
+
+    // The columns modified for a single object
+    class ColumnSet {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = ColKeyType;
+            using difference_type = std::ptrdiff_t;
+            using pointer = ColKeyType const*;
+            using reference = ColKeyType const&;
+
+            iterator(ColumnSet const& set, uint64_t bits, size_t overflow_ndx) noexcept;
+
+            reference operator*() const noexcept;
+            bool operator==(iterator const& other) const noexcept;
+            bool operator!=(iterator const& other) const noexcept { return !(*this == other); }
+            iterator& operator++() noexcept;
+            iterator operator++(int) noexcept
+            {
+                auto value = *this;
+                ++*this;
+                return value;
+            }
+
+        private:
+            ColumnSet const* m_set;
+            // The bits not yet visited, shifted so that bit 0 is column `m_pos`
+            uint64_t m_bits;
+            size_t m_pos = 0;
+            size_t m_overflow_ndx;
+
+            void skip_unset() noexcept;
+        };
+
+        // An empty set of columns
+        ColumnSet() = default;
+
+        iterator begin() const noexcept { return {*this, m_mask & ~overflow_bit, 0}; }
+        iterator end() const noexcept { return {*this, 0, m_overflow ? m_overflow->size() : 0}; }
+
+        bool contains(ColKeyType col) const noexcept;
+        size_t count(ColKeyType col) const noexcept { return contains(col); }
+        size_t size() const noexcept;
+
+    private:
+        uint64_t m_mask = 0;
+        std::vector<ColKeyType> const* m_columns = nullptr;
+        std::vector<ColKeyType> const* m_overflow = nullptr;
+
+        ColumnSet(uint64_t mask, std::vector<ColKeyType> const* columns,
+                  std::vector<ColKeyType> const* overflow) noexcept
+        : m_mask(mask), m_columns(columns), m_overflow(overflow) { }
+        friend class ObjectChangeSet;
+    };
+
+    // The modified objects. Iterating over this gives entries whose `first`
+    // is the key of a modified object and whose `second` is the ColumnSet of
+    // the columns modified in it, as iterating over a map would.
+    class ObjectMapToColumnSet {
+    public:
+        using value_type = std::pair<ObjectKeyType, ColumnSet>;
+
+        // Each entry is built when the iterator reaches it, so a reference
+        // to it is only valid until the iterator is next advanced
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = ObjectMapToColumnSet::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const*;
+            using reference = value_type const&;
+
+            iterator(ObjectChangeSet const& changes, ModificationMap::const_iterator pos) noexcept;
+
+            reference operator*() const noexcept { return m_value; }
+            pointer operator->() const noexcept { return &m_value; }
+            bool operator==(iterator const& other) const noexcept { return m_pos == other.m_pos; }
+            bool operator!=(iterator const& other) const noexcept { return m_pos != other.m_pos; }
+            iterator& operator++() noexcept;
+            iterator operator++(int) noexcept
+            {
+                auto value = *this;
+                ++*this;
+                return value;
+            }
+
+        private:
+            ObjectChangeSet const* m_changes;
+            ModificationMap::const_iterator m_pos;
+            value_type m_value;
+
+            void load() noexcept;
+        };
+        using const_iterator = iterator;
+
+        iterator begin() const noexcept { return {*m_changes, m_changes->m_modifications.begin()}; }
+        iterator end() const noexcept { return {*m_changes, m_changes->m_modifications.end()}; }
+
+        bool empty() const noexcept { return m_changes->m_modifications.empty(); }
+        size_t size() const noexcept { return m_changes->m_modifications.size(); }
+        size_t count(ObjectKeyType obj) const noexcept { return m_changes->m_modifications.count(obj); }
+
+    private:
+        ObjectChangeSet const* m_changes;
+
+        explicit ObjectMapToColumnSet(ObjectChangeSet const& changes) noexcept : m_changes(&changes) { }
+        friend class ObjectChangeSet;
+    };
 
     ObjectChangeSet() = default;
     ObjectChangeSet(ObjectChangeSet const&) = default;
@@ -54,10 +174,13 @@ public:
 
     bool insertions_contains(ObjectKeyType obj) const;
     bool modifications_contains(ObjectKeyType obj) const;
+    // Whether the object was modified in any of the given columns, or in any
+    // column at all if `filtered_column_keys` is empty
+    bool modifications_contains(ObjectKeyType obj, std::vector<ColKeyType> const& filtered_column_keys) const;
     bool deletions_contains(ObjectKeyType obj) const;
-    // if the specified object has not been modified, returns nullptr
-    // if the object has been modified, returns a pointer to the ObjectSet
-    const ObjectSet* get_columns_modified(ObjectKeyType obj) const;
+    // if the specified object has not been modified, returns none
+    // if the object has been modified, returns the set of modified columns
+    util::Optional<ColumnSet> get_columns_modified(ObjectKeyType obj) const;
 
     bool insertions_empty() const noexcept { return m_insertions.empty(); }
     bool modifications_empty() const noexcept { return m_modifications.empty(); }
@@ -76,18 +199,42 @@ public:
         return m_deletions.empty() && m_insertions.empty() && m_modifications.empty() && !m_clear_did_occur;
     }
 
+    // Merge the changes from `other`, which must be the changes made
+    // immediately after the ones in this changeset
     void merge(ObjectChangeSet&& other);
-    void verify();
+    void merge(ObjectChangeSet const& other);
+    void verify() const;
 
     const ObjectSet& get_deletions() const noexcept { return m_deletions; }
-    const ObjectMapToColumnSet& get_modifications() const noexcept { return m_modifications; }
+    ObjectMapToColumnSet get_modifications() const noexcept { return ObjectMapToColumnSet(*this); }
     const ObjectSet& get_insertions() const noexcept { return m_insertions; }
 
+    // The number of bytes of heap memory used to store the changes
+    size_t memory_usage() const noexcept;
+
 private:
+    static constexpr uint64_t overflow_bit = uint64_t(1) << 63;
+    static constexpr size_t max_mask_columns = 63;
+
     ObjectSet m_deletions;
     ObjectSet m_insertions;
-    ObjectMapToColumnSet m_modifications;
+    ModificationMap m_modifications;
+    // The distinct modified columns, in the order of the bits which refer to
+    // them in each modification's mask
+    std::vector<ColKeyType> m_columns;
+    // The columns for objects with the overflow bit set in their mask which
+    // didn't fit in the mask
+    std::unordered_map<ObjectKeyType, std::vector<ColKeyType>> m_overflow_columns;
     bool m_clear_did_occur = false;
+
+    // Set the bit for `col` in `mask`, which is the mask for `obj`
+    void add_column(uint64_t& mask, ObjectKeyType obj, ColKeyType col);
+    // The bit for the given column, adding it to m_columns if needed, or
+    // overflow_bit if there are too many columns
+    uint64_t column_bit(ColKeyType col);
+    bool erase_modification(ObjectKeyType obj);
+    // The columns set in `mask`, which is the mask for `obj`
+    ColumnSet column_set(ObjectKeyType obj, uint64_t mask) const;
 };
 
 } // end namespace realm
@@ -974,17 +974,27 @@ void Results::prepare_async(ForCallback force) NO_THREAD_SAFETY_ANALYSIS
             return;
     }
 
+    std::shared_ptr<_impl::ResultsNotifierBase> notifier;
     if (m_list)
-        m_notifier = std::make_shared<_impl::ListResultsNotifier>(*this);
+        notifier = std::make_shared<_impl::ListResultsNotifier>(*this);
     else
-        m_notifier = std::make_shared<_impl::ResultsNotifier>(*this);
-    _impl::RealmCoordinator::register_notifier(m_notifier);
+        notifier = std::make_shared<_impl::ResultsNotifier>(*this);
+    // The coordinator may give us an existing equivalent notifier to share
+    // rather than registering the new one
+    m_notifier = std::static_pointer_cast<_impl::ResultsNotifierBase>(_impl::RealmCoordinator::register_notifier(std::move(notifier)));
 }
 
-NotificationToken Results::add_notification_callback(CollectionChangeCallback cb) &
+NotificationToken Results::add_notification_callback(CollectionChangeCallback cb,
+                                                     std::chrono::milliseconds min_delivery_interval) &
+{
+    return add_notification_callback(std::move(cb), {}, min_delivery_interval);
+}
+
+NotificationToken Results::add_notification_callback(CollectionChangeCallback cb, KeyPathArray key_path_array,
+                                                     std::chrono::milliseconds min_delivery_interval) &
 {
     prepare_async(ForCallback{true});
-    return {m_notifier, m_notifier->add_callback(std::move(cb))};
+    return {m_notifier, m_notifier.add_callback(std::move(cb), min_delivery_interval, std::move(key_path_array))};
 }
 
 // This function cannot be called on frozen results and so does not require locking
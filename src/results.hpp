@@ -225,7 +225,15 @@ public:
     // Create an async query from this Results
     // The query will be run on a background thread and delivered to the callback,
     // and then rerun after each commit (if needed) and redelivered if it changed
-    NotificationToken add_notification_callback(CollectionChangeCallback cb) &;
+    // If `min_delivery_interval` is non-zero, the callback is called at most
+    // once per interval, with the changes from all of the commits made in
+    // between merged into a single changeset
+    NotificationToken add_notification_callback(CollectionChangeCallback cb,
+                                                std::chrono::milliseconds min_delivery_interval={}) &;
+    // As above, but only modifications to the properties in `key_path_array`
+    // are reported. Insertions and deletions are reported as normal.
+    NotificationToken add_notification_callback(CollectionChangeCallback cb, KeyPathArray key_path_array,
+                                                std::chrono::milliseconds min_delivery_interval={}) &;
 
     // Returns whether the rows are guaranteed to be in table order.
     bool is_in_table_order() const;
@@ -238,6 +238,21 @@ public:
         // speeds up tests that don't need notifications.
         bool automatic_change_notifications = true;
 
+        // The maximum number of threads used to run the background work for
+        // async notifications (query reruns and changeset calculation) for
+        // this file. With a value greater than one, independent notifiers are
+        // split into groups which each run in parallel on their own read
+        // transaction. Only the value from the first Realm opened for a path
+        // is used.
+        size_t notifier_thread_count = 1;
+
+        // The maximum number of objects in a chain of links, starting from
+        // and including the object itself, which is followed when checking
+        // whether an object in a collection was modified for change
+        // notifications. Changes to objects further away are not reported.
+        // Only the value from the first Realm opened for a path is used.
+        size_t max_notification_link_depth = 4;
+
         // The Scheduler which this Realm should be bound to. If not supplied,
         // a default one for the current thread will be used.
         std::shared_ptr<util::Scheduler> scheduler;
@@ -0,0 +1,506 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Micro-benchmarks for the data structures which every collection
+// notification goes through: IndexSet, the ChunkedRangeVector it's built on,
+// CollectionChangeBuilder's merge() and finalize(), and the ObjectChangeSets
+// built for each table by the transaction log observer. Each benchmark applies
+// a synthetic change pattern and reports the time, number of heap allocations
+// and bytes allocated per operation, so that regressions in any of them show
+// up directly.
+//
+// This is a separate executable from the Catch benchmarks as it replaces the
+// global operator new to count allocations. Pass a string as the first
+// argument to only run the benchmarks whose names contain it.
+
+#include "index_set.hpp"
+#include "object_changeset.hpp"
+#include "impl/collection_change_builder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_bytes_allocated{0};
+} // anonymous namespace
+
+void* operator new(size_t size)
+{
+    ++g_allocations;
+    g_bytes_allocated += size;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const char* g_filter = nullptr;
+// Written to with each benchmark's result so that the work isn't optimized away
+volatile size_t g_sink;
+
+// Run `body` on fresh state produced by `setup` until at least 100ms have
+// been spent in `body`, and then report the time, allocations and bytes
+// allocated per operation, where `body` is taken to perform `ops` operations each time.
+// Only `body` is timed and counted, so setup can be as expensive as needed.
+template<typename Setup, typename Body>
+void run(const char* name, size_t ops, Setup&& setup, Body&& body)
+{
+    if (g_filter && !std::strstr(name, g_filter))
+        return;
+
+    Clock::duration elapsed{};
+    size_t allocations = 0;
+    size_t bytes = 0;
+    size_t iterations = 0;
+    while (elapsed < std::chrono::milliseconds(100) || iterations < 3) {
+        auto state = setup();
+        size_t allocations_before = g_allocations;
+        size_t bytes_before = g_bytes_allocated;
+        auto start = Clock::now();
+        g_sink = body(state);
+        elapsed += Clock::now() - start;
+        allocations += g_allocations - allocations_before;
+        bytes += g_bytes_allocated - bytes_before;
+        ++iterations;
+    }
+
+    double total_ops = double(ops) * iterations;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    std::printf("%-60s %12.1f ns/op %10.3f allocs/op %10.1f bytes/op\n",
+                name, ns / total_ops, allocations / total_ops, bytes / total_ops);
+}
+
+// Set up nothing, for benchmarks which start from empty objects
+struct Empty { };
+Empty none() { return {}; }
+
+// The arguments to apply a single edit to a collection of a known size
+struct Edit {
+    enum class Kind { Insert, Erase, Modify, Move } kind;
+    size_t ndx;
+    size_t to;
+};
+
+// Generate a random sequence of edits to a collection which starts out with
+// `size` rows, keeping track of the size so that every edit is valid
+std::vector<Edit> random_edits(std::mt19937_64& rng, size_t size, size_t count, bool moves)
+{
+    std::vector<Edit> edits;
+    edits.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto kind = Edit::Kind(rng() % (moves ? 4 : 3));
+        if (size < 2 && kind != Edit::Kind::Insert)
+            kind = Edit::Kind::Insert;
+        switch (kind) {
+            case Edit::Kind::Insert:
+                edits.push_back({kind, size_t(rng() % (size + 1)), 0});
+                ++size;
+                break;
+            case Edit::Kind::Erase:
+                edits.push_back({kind, size_t(rng() % size), 0});
+                --size;
+                break;
+            case Edit::Kind::Modify:
+                edits.push_back({kind, size_t(rng() % size), 0});
+                break;
+            case Edit::Kind::Move: {
+                size_t from = rng() % size, to = rng() % size;
+                if (from == to)
+                    to = (to + 1) % size;
+                edits.push_back({kind, from, to});
+                break;
+            }
+        }
+    }
+    return edits;
+}
+
+void apply(CollectionChangeBuilder& builder, Edit const& edit)
+{
+    switch (edit.kind) {
+        case Edit::Kind::Insert: builder.insert(edit.ndx); break;
+        case Edit::Kind::Erase: builder.erase(edit.ndx); break;
+        case Edit::Kind::Modify: builder.modify(edit.ndx); break;
+        case Edit::Kind::Move: builder.move(edit.ndx, edit.to); break;
+    }
+}
+
+size_t size_of(CollectionChangeSet const& changes)
+{
+    return changes.deletions.count() + changes.insertions.count()
+         + changes.modifications.count() + changes.moves.size();
+}
+
+void benchmark_index_set()
+{
+    const size_t ops = 10'000;
+
+    run("IndexSet: prepend with insert_at(0)", ops, none, [&](Empty&) {
+        IndexSet set;
+        for (size_t i = 0; i < ops; ++i)
+            set.insert_at(0);
+        return set.count();
+    });
+
+    run("IndexSet: prepend alternating rows", ops, none, [&](Empty&) {
+        IndexSet set;
+        for (size_t i = 0; i < ops; ++i) {
+            set.shift_for_insert_at(0);
+            set.insert_at(0);
+        }
+        return set.count();
+    });
+
+    std::mt19937_64 rng(0);
+    std::vector<size_t> sparse(ops);
+    for (auto& i : sparse)
+        i = rng() % 10'000'000;
+
+    run("IndexSet: add() random sparse rows", ops, none, [&](Empty&) {
+        IndexSet set;
+        for (size_t i : sparse)
+            set.add(i);
+        return set.count();
+    });
+
+    IndexSet sparse_set;
+    for (size_t i : sparse)
+        sparse_set.add(i);
+
+    run("IndexSet: insert_at() random sparse rows", ops,
+        [&] { return sparse_set; },
+        [&](IndexSet& set) {
+            for (size_t i : sparse)
+                set.insert_at(i);
+            return set.count();
+        });
+
+    run("IndexSet: erase_at() random sparse rows", ops,
+        [&] { return sparse_set; },
+        [&](IndexSet& set) {
+            for (size_t i : sparse)
+                set.erase_at(i % 5'000'000);
+            return set.count();
+        });
+
+    run("IndexSet: shift() random sparse rows", ops, none, [&](Empty&) {
+        size_t sum = 0;
+        for (size_t i : sparse)
+            sum += sparse_set.shift(i);
+        return sum;
+    });
+
+    // unshift() requires indexes which aren't in the set
+    std::vector<size_t> missing;
+    for (size_t i : sparse) {
+        if (!sparse_set.contains(i + 1))
+            missing.push_back(i + 1);
+    }
+    run("IndexSet: unshift() random sparse rows", missing.size(), none, [&](Empty&) {
+        size_t sum = 0;
+        for (size_t i : missing)
+            sum += sparse_set.unshift(i);
+        return sum;
+    });
+
+    run("IndexSet: count() random sparse ranges", ops, none, [&](Empty&) {
+        size_t sum = 0;
+        for (size_t i : sparse)
+            sum += sparse_set.count(i / 2, i);
+        return sum;
+    });
+
+    IndexSet other;
+    for (size_t i = 0; i < ops; ++i)
+        other.add(rng() % 10'000'000);
+
+    run("IndexSet: add(IndexSet) random sparse rows", ops,
+        [&] { return sparse_set; },
+        [&](IndexSet& set) {
+            set.add(other);
+            return set.count();
+        });
+
+    run("IndexSet: erase_at(IndexSet) random sparse rows", ops,
+        [&] { return sparse_set; },
+        [&](IndexSet& set) {
+            set.erase_at(other);
+            return set.count();
+        });
+}
+
+void benchmark_chunked_range_vector()
+{
+    const size_t ops = 10'000;
+
+    run("ChunkedRangeVector: push_back() disjoint ranges", ops, none, [&](Empty&) {
+        ChunkedRangeVector ranges;
+        for (size_t i = 0; i < ops; ++i)
+            ranges.push_back({i * 2, i * 2 + 1});
+        return ranges.range_count();
+    });
+
+    run("ChunkedRangeVector: insert() at front", ops, none, [&](Empty&) {
+        ChunkedRangeVector ranges;
+        for (size_t i = 0; i < ops; ++i)
+            ranges.insert(ranges.begin(), {(ops - i) * 2, (ops - i) * 2 + 1});
+        return ranges.range_count();
+    });
+
+    ChunkedRangeVector full;
+    for (size_t i = 0; i < ops; ++i)
+        full.push_back({i * 2, i * 2 + 1});
+
+    run("ChunkedRangeVector: erase() from front", ops,
+        [&] { return full; },
+        [&](ChunkedRangeVector& ranges) {
+            while (!ranges.empty())
+                ranges.erase(ranges.begin());
+            return ranges.range_count();
+        });
+
+    run("ChunkedRangeVector: iterate", ops, none, [&](Empty&) {
+        size_t sum = 0;
+        for (auto range : full)
+            sum += range.first;
+        return sum;
+    });
+}
+
+void benchmark_change_builder()
+{
+    std::mt19937_64 rng(0);
+
+    const size_t prepends = 1'000;
+    run("CollectionChangeBuilder: prepend rows", prepends, none, [&](Empty&) {
+        CollectionChangeBuilder builder;
+        for (size_t i = 0; i < prepends; ++i)
+            builder.insert(0);
+        return builder.insertions.count();
+    });
+
+    const size_t table_size = 100'000;
+    auto sparse_edits = random_edits(rng, table_size, 1'000, false);
+    run("CollectionChangeBuilder: random sparse edits", sparse_edits.size(), none, [&](Empty&) {
+        CollectionChangeBuilder builder;
+        for (auto& edit : sparse_edits)
+            apply(builder, edit);
+        return builder.insertions.count();
+    });
+
+    const size_t move_count = 200;
+    std::vector<Edit> large_moves;
+    for (size_t i = 0; i < move_count; ++i)
+        large_moves.push_back({Edit::Kind::Move, rng() % (table_size / 2), table_size / 2 + rng() % (table_size / 2)});
+    run("CollectionChangeBuilder: large moves", move_count, none, [&](Empty&) {
+        CollectionChangeBuilder builder;
+        for (auto& edit : large_moves)
+            apply(builder, edit);
+        return builder.moves.size();
+    });
+
+    run("CollectionChangeBuilder: clear and reinsert", table_size, none, [&](Empty&) {
+        CollectionChangeBuilder builder;
+        builder.modify(5);
+        builder.erase(10);
+        builder.clear(table_size);
+        for (size_t i = 0; i < table_size; ++i)
+            builder.insert(i);
+        return builder.insertions.count();
+    });
+
+    // Long chains of small commits, each of which is calculated separately
+    // and then merged into the changes so far as the notifier does when it
+    // has fallen behind
+    auto merge_chain = [&](const char* name, size_t commits, size_t edits_per_commit, bool moves) {
+        std::vector<CollectionChangeBuilder> changes;
+        size_t size = table_size;
+        for (size_t i = 0; i < commits; ++i) {
+            CollectionChangeBuilder builder;
+            for (auto& edit : random_edits(rng, size, edits_per_commit, moves)) {
+                apply(builder, edit);
+                if (edit.kind == Edit::Kind::Insert)
+                    ++size;
+                else if (edit.kind == Edit::Kind::Erase)
+                    --size;
+            }
+            changes.push_back(std::move(builder));
+        }
+
+        run(name, commits, [&] { return changes; },
+            [&](std::vector<CollectionChangeBuilder>& changes) {
+                CollectionChangeBuilder merged;
+                for (auto& change : changes)
+                    merged.merge(std::move(change));
+                return size_of(std::move(merged).finalize());
+            });
+    };
+    merge_chain("CollectionChangeBuilder: merge() 100 commits", 100, 10, false);
+    merge_chain("CollectionChangeBuilder: merge() 500 commits", 500, 10, false);
+    merge_chain("CollectionChangeBuilder: merge() 100 commits with moves", 100, 10, true);
+
+    CollectionChangeBuilder merged_changes;
+    for (size_t i = 0; i < 100; ++i) {
+        CollectionChangeBuilder builder;
+        for (auto& edit : random_edits(rng, table_size, 100, false))
+            apply(builder, edit);
+        merged_changes.merge(std::move(builder));
+    }
+    run("CollectionChangeBuilder: finalize()", 1, [&] { return merged_changes; },
+        [&](CollectionChangeBuilder& builder) {
+            return size_of(std::move(builder).finalize());
+        });
+
+    // The same as the merge chain above, but allocating the chunks from an
+    // arena as the notifier thread does
+    ChunkArena arena;
+    std::vector<CollectionChangeBuilder> chain;
+    for (size_t i = 0; i < 100; ++i) {
+        CollectionChangeBuilder builder;
+        for (auto& edit : random_edits(rng, table_size, 10, false))
+            apply(builder, edit);
+        chain.push_back(std::move(builder));
+    }
+    run("CollectionChangeBuilder: merge() 100 commits in arena", chain.size(),
+        [&] { arena.reset(); return chain; },
+        [&](std::vector<CollectionChangeBuilder>& changes) {
+            ChunkArena::Scope scope(arena);
+            CollectionChangeBuilder merged;
+            for (auto& change : changes)
+                merged.merge(std::move(change));
+            return size_of(std::move(merged).finalize());
+        });
+}
+void benchmark_object_changeset()
+{
+    // A bulk update of a few columns of every object in a large table
+    const size_t object_count = 1'000'000;
+    const size_t column_count = 3;
+    auto modify_all = [&] {
+        ObjectChangeSet changes;
+        for (size_t col = 0; col < column_count; ++col) {
+            for (size_t obj = 0; obj < object_count; ++obj)
+                changes.modifications_add(obj, col);
+        }
+        return changes;
+    };
+
+    run("ObjectChangeSet: modify 1M objects x 3 columns", object_count * column_count, none, [&](Empty&) {
+        return modify_all().modifications_size();
+    });
+
+    run("ObjectChangeSet: insert and delete 1M objects", object_count, none, [&](Empty&) {
+        ObjectChangeSet changes;
+        for (size_t obj = 0; obj < object_count; ++obj) {
+            changes.insertions_add(obj + object_count);
+            changes.deletions_add(obj);
+        }
+        return changes.insertions_size() + changes.deletions_size();
+    });
+
+    auto modified = modify_all();
+    run("ObjectChangeSet: get_columns_modified() 1M objects", object_count, none, [&](Empty&) {
+        size_t count = 0;
+        for (size_t obj = 0; obj < object_count; ++obj) {
+            if (auto columns = modified.get_columns_modified(obj)) {
+                for (auto col : *columns)
+                    count += col;
+            }
+        }
+        return count;
+    });
+
+    // The changes to each of many small tables, as gathered when advancing a
+    // notifier group, both from the heap and from an arena
+    const size_t table_count = 1'000;
+    auto modify_tables = [&] {
+        std::vector<ObjectChangeSet> tables(table_count);
+        for (auto& table : tables) {
+            for (size_t obj = 0; obj < 20; ++obj) {
+                table.modifications_add(obj * 3, 0);
+                table.insertions_add(obj * 3 + 1);
+                table.deletions_add(obj * 3 + 2);
+            }
+        }
+        return tables.size();
+    };
+    run("ObjectChangeSet: modify 1000 small tables", table_count, none, [&](Empty&) {
+        return modify_tables();
+    });
+
+    ChunkArena arena;
+    run("ObjectChangeSet: modify 1000 small tables in arena", table_count,
+        [&] { arena.reset(); return Empty(); },
+        [&](Empty&) {
+            ChunkArena::Scope scope(arena);
+            return modify_tables();
+        });
+
+    // Merge the changes from a long run of transactions which each modify a
+    // different column of every object
+    run("ObjectChangeSet: merge() 1M object changesets", object_count,
+        [&] {
+            std::vector<ObjectChangeSet> changes;
+            for (size_t col = 0; col < 4; ++col) {
+                ObjectChangeSet change;
+                for (size_t obj = 0; obj < object_count / 4; ++obj)
+                    change.modifications_add(obj * 4 + col, col);
+                change.deletions_add(col);
+                changes.push_back(std::move(change));
+            }
+            return changes;
+        },
+        [&](std::vector<ObjectChangeSet>& changes) {
+            ObjectChangeSet merged;
+            for (auto& change : changes)
+                merged.merge(std::move(change));
+            return merged.modifications_size();
+        });
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+        g_filter = argv[1];
+
+    benchmark_index_set();
+    benchmark_chunked_range_vector();
+    benchmark_change_builder();
+    benchmark_object_changeset();
+    return 0;
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "catch2/catch.hpp"
+
+#include "index_set.hpp"
+#include "impl/collection_change_builder.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace realm;
+
+TEST_CASE("Benchmark index set algebra", "[benchmark]") {
+    // Each benchmark applies an operation taking another set to a fresh copy
+    // of `a` so that the inputs are the same for every run
+    auto benchmark_operations = [](std::string const& name, IndexSet const& a, IndexSet const& b) {
+        BENCHMARK_ADVANCED(name + ": add()")(Catch::Benchmark::Chronometer meter) {
+            std::vector<IndexSet> sets(meter.runs(), a);
+            meter.measure([&](int i) { sets[i].add(b); });
+        };
+        BENCHMARK_ADVANCED(name + ": remove()")(Catch::Benchmark::Chronometer meter) {
+            std::vector<IndexSet> sets(meter.runs(), a);
+            meter.measure([&](int i) { sets[i].remove(b); });
+        };
+        BENCHMARK_ADVANCED(name + ": insert_at()")(Catch::Benchmark::Chronometer meter) {
+            std::vector<IndexSet> sets(meter.runs(), a);
+            meter.measure([&](int i) { sets[i].insert_at(b); });
+        };
+        BENCHMARK_ADVANCED(name + ": shift_for_insert_at()")(Catch::Benchmark::Chronometer meter) {
+            std::vector<IndexSet> sets(meter.runs(), a);
+            meter.measure([&](int i) { sets[i].shift_for_insert_at(b); });
+        };
+        BENCHMARK_ADVANCED(name + ": erase_at()")(Catch::Benchmark::Chronometer meter) {
+            std::vector<IndexSet> sets(meter.runs(), a);
+            meter.measure([&](int i) { sets[i].erase_at(b); });
+        };
+    };
+
+    IndexSet a, b;
+
+    SECTION("dense") {
+        // A few long ranges which partially overlap
+        for (size_t i = 0; i < 1'000'000; i += 100'000) {
+            a.add(i, i + 60'000);
+            b.add(i + 50'000, i + 90'000);
+        }
+        benchmark_operations("dense", a, b);
+    }
+
+    SECTION("sparse") {
+        std::mt19937_64 rng(0);
+        for (size_t i = 0; i < 10'000; ++i) {
+            a.add(rng() % 10'000'000);
+            b.add(rng() % 10'000'000);
+        }
+        benchmark_operations("sparse", a, b);
+    }
+
+    SECTION("interleaved") {
+        for (size_t i = 0; i < 300'000; i += 3) {
+            a.add(i);
+            b.add(i + 1);
+        }
+        benchmark_operations("interleaved", a, b);
+    }
+}
+
+TEST_CASE("Benchmark index set arena allocation", "[benchmark]") {
+    // Build and then throw away a changeset for each of a few hundred
+    // notifiers, as the notifier thread does on every run
+    auto build_changesets = [] {
+        std::vector<_impl::CollectionChangeBuilder> changes(200);
+        for (auto& change : changes) {
+            for (size_t i = 0; i < 50; ++i) {
+                change.insert(i * 3);
+                change.modify(i * 7, i % 4);
+                change.erase(i * 5 + 1);
+            }
+        }
+        return changes.size();
+    };
+
+    BENCHMARK("heap") {
+        return build_changesets();
+    };
+
+    _impl::ChunkArena arena;
+    BENCHMARK("arena") {
+        size_t count;
+        {
+            _impl::ChunkArena::Scope scope(arena);
+            count = build_changesets();
+        }
+        arena.reset();
+        return count;
+    };
+}
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "util/test_file.hpp"
+#include "util/test_utils.hpp"
+
+#include "impl/realm_coordinator.hpp"
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+
+#include <realm/db.hpp>
+
+using namespace realm;
+
+namespace realm {
+class TestHelper {
+public:
+    static DBRef& get_db(SharedRealm const& shared_realm)
+    {
+        return Realm::Internal::get_db(*shared_realm);
+    }
+};
+}
+
+TEST_CASE("Benchmark per-commit notifier overhead", "[benchmark]") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto& db = TestHelper::get_db(r);
+    auto table = r->read_group().get_table("class_object");
+    auto col = table->get_column_key("value");
+
+    r->begin_transaction();
+    for (int i = 0; i < 100; ++i)
+        table->create_object().set(col, i);
+    r->commit_transaction();
+
+    // Commits are made from a Realm which isn't observed so that the
+    // measurements don't include delivering the notifications
+    auto writer = coordinator->get_realm(util::Scheduler::get_frozen());
+    auto writer_table = writer->read_group().get_table("class_object");
+    auto commit = [&] {
+        writer->begin_transaction();
+        writer_table->begin()->set(col, writer_table->begin()->get<Int>(col) + 1);
+        writer->commit_transaction();
+    };
+
+    Results results(r, table->where());
+    size_t calls = 0;
+    auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+        ++calls;
+    });
+    advance_and_notify(*r);
+    REQUIRE(calls == 1);
+
+    BENCHMARK("commit") {
+        commit();
+    };
+
+    // How run_async_notifiers() used to find the latest version
+    BENCHMARK("commit, then start_read() to get latest version") {
+        commit();
+        return db->start_read()->get_version_of_current_transaction();
+    };
+
+    // How run_async_notifiers() finds the latest version now
+    auto probe = db->start_read();
+    BENCHMARK("commit, then advance_read() to get latest version") {
+        commit();
+        if (db->get_version_of_latest_snapshot() != probe->get_version_of_current_transaction().version)
+            probe->advance_read();
+        return probe->get_version_of_current_transaction();
+    };
+    probe = nullptr;
+
+    BENCHMARK("commit, then run notifiers") {
+        commit();
+        coordinator->on_change();
+    };
+
+    BENCHMARK("run notifiers with no new commits") {
+        coordinator->on_change();
+    };
+
+    r->notify();
+    REQUIRE(calls > 1);
+}
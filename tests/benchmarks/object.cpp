@@ -22,6 +22,7 @@
 #include "util/test_file.hpp"
 #include "util/test_utils.hpp"
 
+#include "impl/notifier_worker_pool.hpp"
 #include "impl/object_accessor_impl.hpp"
 #include "impl/realm_coordinator.hpp"
 #include "binding_context.hpp"
@@ -34,7 +35,9 @@
 #include <realm/query_engine.hpp>
 #include <realm/query_expression.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <random>
 #include <vector>
 
 using namespace realm;
@@ -125,6 +128,76 @@ TEST_CASE("Benchmark index change calculations", "[benchmark]") {
         REQUIRE_INDICES(c.insertions, 0, 1);
         REQUIRE_INDICES(c.deletions, 1, 2);
     }
+
+    SECTION("reorderings of large sorted results") {
+        constexpr size_t indices_size = 100000;
+        std::vector<size_t> indices;
+        indices.reserve(indices_size);
+        for (size_t i = 0; i < indices_size; ++i)
+            indices.push_back(i);
+
+        auto few_moved = indices;
+        std::mt19937_64 rng(0);
+        for (size_t i = 0; i < 1000; ++i)
+            std::swap(few_moved[rng() % indices_size], few_moved[rng() % indices_size]);
+        BENCHMARK("1000 rows swapped") {
+            c = _impl::CollectionChangeBuilder::calculate(indices, few_moved, none_modified);
+        };
+
+        auto reversed = indices;
+        std::reverse(reversed.begin(), reversed.end());
+        BENCHMARK("reversed") {
+            c = _impl::CollectionChangeBuilder::calculate(indices, reversed, none_modified);
+        };
+        REQUIRE(c.insertions.count() == c.deletions.count());
+
+        auto shuffled = indices;
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+        BENCHMARK("shuffled") {
+            c = _impl::CollectionChangeBuilder::calculate(indices, shuffled, none_modified);
+        };
+        REQUIRE(c.insertions.count() == c.deletions.count());
+    }
+
+    SECTION("parallel calculation for very large results") {
+        auto some_modified = [](int64_t key) { return key % 100 == 0; };
+        for (size_t row_count : {1'000'000, 10'000'000}) {
+            std::vector<int64_t> prev;
+            prev.reserve(row_count);
+            for (size_t i = 0; i < row_count; ++i)
+                prev.push_back(i * 2);
+
+            // Replace a few scattered rows with new ones
+            auto next = prev;
+            std::mt19937_64 rng(0);
+            for (size_t i = 0; i < 100; ++i)
+                next[rng() % row_count] = rng() % row_count * 2 + 1;
+            std::sort(next.begin(), next.end());
+
+            for (size_t thread_count : {1, 2, 4, 8}) {
+                _impl::NotifierWorkerPool pool(thread_count - 1);
+                BENCHMARK(std::to_string(row_count) + " rows in table order, " + std::to_string(thread_count) + " threads") {
+                    c = _impl::CollectionChangeBuilder::calculate_parallel(prev, next, some_modified, true, pool);
+                };
+                REQUIRE(c.insertions.count() == c.deletions.count());
+            }
+
+            // The same changes, but with the rows in a sort order unrelated to their keys
+            auto shuffled_prev = prev;
+            std::shuffle(shuffled_prev.begin(), shuffled_prev.end(), rng);
+            auto shuffled_next = shuffled_prev;
+            for (size_t i = 0; i < 100; ++i)
+                shuffled_next[rng() % row_count] = rng() % row_count * 2 + 1;
+            for (size_t thread_count : {1, 2, 4, 8}) {
+                _impl::NotifierWorkerPool pool(thread_count - 1);
+                BENCHMARK(std::to_string(row_count) + " sorted rows, " + std::to_string(thread_count) + " threads") {
+                    c = _impl::CollectionChangeBuilder::calculate_parallel(shuffled_prev, shuffled_next,
+                                                                           some_modified, false, pool);
+                };
+                REQUIRE(c.insertions.count() == c.deletions.count());
+            }
+        }
+    }
 }
 
 TEST_CASE("Benchmark object", "[benchmark]") {
@@ -19,10 +19,15 @@
 #include "catch2/catch.hpp"
 
 #include "impl/collection_notifier.hpp"
+#include "impl/notifier_worker_pool.hpp"
 
 #include "util/index_helpers.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <map>
+#include <random>
+#include <set>
 
 using namespace realm;
 
@@ -335,6 +340,41 @@ TEST_CASE("collection_change: calculate() table order") {
         REQUIRE_INDICES(c.modifications, 0);
     }
 
+    SECTION("reports runs of insertions, deletions and modifications") {
+        auto modified = [](int64_t key) { return key >= 4 && key < 7; };
+        c = _impl::CollectionChangeBuilder::calculate({1, 2, 3, 4, 5, 6, 7, 8, 9}, {0, 1, 4, 5, 6, 7, 10, 11, 12},
+                                                      modified, in_table_order);
+        REQUIRE_INDICES(c.deletions, 1, 2, 7, 8);
+        REQUIRE_INDICES(c.insertions, 0, 6, 7, 8);
+        REQUIRE_INDICES(c.modifications, 2, 3, 4);
+    }
+
+    SECTION("checks rows against a single table's modifications") {
+        ObjectChangeSet changes;
+        for (int64_t key : {0, 4, 5, 6, 9, 12})
+            changes.modifications_add(key, 0);
+        _impl::TableChangeChecker checker(changes);
+        std::vector<int64_t> rows;
+        for (int64_t i = 1; i < 100; ++i)
+            rows.push_back(i);
+
+        c = _impl::CollectionChangeBuilder::calculate(rows, rows, checker, in_table_order);
+        REQUIRE_INDICES(c.modifications, 3, 4, 5, 8, 11);
+
+        c = _impl::CollectionChangeBuilder::calculate({1, 2, 3, 4, 5, 6, 7, 8, 9}, {0, 1, 4, 5, 6, 7, 10, 11, 12},
+                                                      checker, in_table_order);
+        REQUIRE_INDICES(c.modifications, 2, 3, 4);
+
+        c = _impl::CollectionChangeBuilder::calculate(rows, rows, _impl::NoChangesChecker(), in_table_order);
+        REQUIRE(c.empty());
+    }
+
+    SECTION("handles unsorted input") {
+        c = _impl::CollectionChangeBuilder::calculate({3, 1, 2}, {3, 2, 4}, none_modified, in_table_order);
+        REQUIRE_INDICES(c.deletions, 1);
+        REQUIRE_INDICES(c.insertions, 2);
+    }
+
 #if 0 // FIXME: these tests might be applicable to LinkingObjects
     SECTION("reports moves which can be produced by move_last_over()") {
         auto calc = [&](std::vector<int64_t> values) {
@@ -643,6 +683,41 @@ TEST_CASE("collection_change: calculate() sorted") {
         REQUIRE_INDICES(c.insertions, 0, 3, 7, 10);
     }
 
+    SECTION("reports every row after the first difference as deleted and inserted when the cost limit is zero") {
+        c = _impl::CollectionChangeBuilder::calculate({1, 2, 3, 4}, {1, 3, 2, 4}, none_modified, 0);
+        REQUIRE_INDICES(c.deletions, 1, 2, 3);
+        REQUIRE_INDICES(c.insertions, 1, 2, 3);
+    }
+
+    SECTION("keeps the matches found before reaching the cost limit") {
+        std::vector<size_t> prev, next;
+        for (size_t i = 0; i < 100; ++i)
+            prev.push_back(i);
+        next = prev;
+        std::swap(next[10], next[90]);
+
+        c = _impl::CollectionChangeBuilder::calculate(prev, next, none_modified);
+        REQUIRE_INDICES(c.deletions, 10, 90);
+        REQUIRE_INDICES(c.insertions, 10, 90);
+
+        // Enough to find the longest match but not to search the blocks around it
+        c = _impl::CollectionChangeBuilder::calculate(prev, next, none_modified, 100);
+        REQUIRE(c.deletions.count() == c.insertions.count());
+        REQUIRE(c.deletions.count() > 2);
+        REQUIRE(c.deletions.count() < 90);
+    }
+
+    SECTION("handles reorderings too large to find all of the moves in") {
+        std::vector<size_t> prev, next;
+        for (size_t i = 0; i < 10000; ++i) {
+            prev.push_back(i);
+            next.push_back(9999 - i);
+        }
+        c = _impl::CollectionChangeBuilder::calculate(prev, next, none_modified);
+        REQUIRE(c.deletions.count() == c.insertions.count());
+        REQUIRE(c.deletions.count() >= 9999);
+    }
+
     SECTION("produces diffs which let merge collapse insert -> move -> delete to no-op") {
         auto four_modified = [](size_t ndx) { return ndx == 4; };
         for (int insert_pos = 0; insert_pos < 4; ++insert_pos) {
@@ -667,6 +742,71 @@ TEST_CASE("collection_change: calculate() sorted") {
     }
 }
 
+TEST_CASE("collection_change: calculate_parallel()") {
+    _impl::NotifierWorkerPool pool(3);
+    _impl::CollectionChangeBuilder c;
+
+    auto none_modified = [](int64_t) { return false; };
+    auto some_modified = [](int64_t key) { return key % 3 == 0; };
+
+    auto require_same = [](_impl::CollectionChangeBuilder const& lft, _impl::CollectionChangeBuilder const& rgt) {
+        REQUIRE(std::equal(lft.deletions.begin(), lft.deletions.end(), rgt.deletions.begin(), rgt.deletions.end()));
+        REQUIRE(std::equal(lft.insertions.begin(), lft.insertions.end(), rgt.insertions.begin(), rgt.insertions.end()));
+        REQUIRE(std::equal(lft.modifications.begin(), lft.modifications.end(),
+                           rgt.modifications.begin(), rgt.modifications.end()));
+    };
+
+    std::mt19937_64 rng(0);
+    auto random_rows = [&](size_t size) {
+        std::vector<int64_t> rows;
+        for (size_t i = 0; i < size; ++i) {
+            if (rng() % 4)
+                rows.push_back(i);
+        }
+        return rows;
+    };
+
+    SECTION("produces the same changes as calculate() for rows in table order") {
+        for (size_t i = 0; i < 100; ++i) {
+            auto prev = random_rows(1000), next = random_rows(1000);
+            require_same(_impl::CollectionChangeBuilder::calculate_parallel(prev, next, some_modified, true, pool, 0),
+                         _impl::CollectionChangeBuilder::calculate(prev, next, some_modified, true));
+        }
+    }
+
+    SECTION("produces the same changes as calculate() for sorted rows") {
+        for (size_t i = 0; i < 100; ++i) {
+            auto prev = random_rows(1000), next = random_rows(1000);
+            std::shuffle(prev.begin(), prev.end(), rng);
+            std::shuffle(next.begin(), next.end(), rng);
+            require_same(_impl::CollectionChangeBuilder::calculate_parallel(prev, next, some_modified, false, pool, 0),
+                         _impl::CollectionChangeBuilder::calculate(prev, next, some_modified, false));
+        }
+    }
+
+    SECTION("stitches together runs which span multiple key ranges") {
+        std::vector<int64_t> prev, next;
+        for (int64_t i = 0; i < 100; ++i) {
+            prev.push_back(i);
+            next.push_back(i < 10 || i >= 90 ? i : i + 100);
+        }
+        c = _impl::CollectionChangeBuilder::calculate_parallel(prev, next, none_modified, true, pool, 0);
+        REQUIRE(c.deletions.count() == 80);
+        REQUIRE(c.insertions.count() == 80);
+        REQUIRE(std::distance(c.deletions.begin(), c.deletions.end()) == 1);
+        REQUIRE(std::distance(c.insertions.begin(), c.insertions.end()) == 1);
+    }
+
+    SECTION("handles empty and tiny inputs") {
+        c = _impl::CollectionChangeBuilder::calculate_parallel({}, {}, some_modified, true, pool, 0);
+        REQUIRE(c.empty());
+        c = _impl::CollectionChangeBuilder::calculate_parallel({}, {1, 2}, some_modified, true, pool, 0);
+        REQUIRE_INDICES(c.insertions, 0, 1);
+        c = _impl::CollectionChangeBuilder::calculate_parallel({3, 1, 2}, {}, some_modified, false, pool, 0);
+        REQUIRE_INDICES(c.deletions, 0, 1, 2);
+    }
+}
+
 TEST_CASE("collection_change: merge()") {
     _impl::CollectionChangeBuilder c;
 
@@ -963,3 +1103,174 @@ TEST_CASE("collection_change: merge()") {
         }
     }
 }
+
+TEST_CASE("object_changeset") {
+    ObjectChangeSet c;
+    auto columns = [&](int64_t obj) {
+        std::vector<int64_t> cols;
+        if (auto modified = c.get_columns_modified(obj))
+            cols.assign(modified->begin(), modified->end());
+        std::sort(cols.begin(), cols.end());
+        return cols;
+    };
+
+    SECTION("tracks the modified columns for each object") {
+        c.modifications_add(1, 10);
+        c.modifications_add(1, 12);
+        c.modifications_add(2, 12);
+        c.modifications_add(1, 10);
+        REQUIRE(c.modifications_size() == 2);
+        REQUIRE(columns(1) == (std::vector<int64_t>{10, 12}));
+        REQUIRE(columns(2) == (std::vector<int64_t>{12}));
+        REQUIRE_FALSE(c.get_columns_modified(3));
+        REQUIRE(c.get_columns_modified(1)->count(12) == 1);
+        REQUIRE(c.get_columns_modified(2)->count(10) == 0);
+    }
+
+    SECTION("get_modifications() gives the modified columns of each object") {
+        for (int64_t col = 0; col < 100; ++col)
+            c.modifications_add(col % 2, col);
+        c.modifications_add(2, 12);
+
+        std::map<int64_t, std::vector<int64_t>> modifications;
+        for (auto& modification : c.get_modifications()) {
+            auto& cols = modifications[modification.first];
+            cols.assign(modification.second.begin(), modification.second.end());
+            std::sort(cols.begin(), cols.end());
+            REQUIRE(modification.second.size() == cols.size());
+        }
+        REQUIRE(c.get_modifications().size() == 3);
+        REQUIRE(modifications.size() == 3);
+        for (int64_t obj = 0; obj < 3; ++obj)
+            REQUIRE(modifications[obj] == columns(obj));
+    }
+
+    SECTION("does not report modifications on new objects") {
+        c.insertions_add(1);
+        c.modifications_add(1, 10);
+        REQUIRE_FALSE(c.modifications_contains(1));
+        REQUIRE(c.insertions_contains(1));
+    }
+
+    SECTION("deleting an inserted object removes the insertion") {
+        c.insertions_add(1);
+        c.deletions_add(1);
+        REQUIRE_FALSE(c.insertions_contains(1));
+        REQUIRE_FALSE(c.deletions_contains(1));
+        REQUIRE(c.empty());
+    }
+
+    SECTION("deleting a modified object removes the modification") {
+        c.modifications_add(1, 10);
+        c.deletions_add(1);
+        REQUIRE_FALSE(c.modifications_contains(1));
+        REQUIRE(c.deletions_contains(1));
+    }
+
+    SECTION("handles more columns than fit in the mask") {
+        for (int64_t col = 0; col < 100; ++col)
+            c.modifications_add(col % 2, col);
+        c.modifications_add(2, 99);
+        REQUIRE(columns(0).size() == 50);
+        REQUIRE(columns(1).size() == 50);
+        REQUIRE(columns(1).back() == 99);
+        REQUIRE(columns(2) == (std::vector<int64_t>{99}));
+        REQUIRE(c.get_columns_modified(1)->contains(97));
+        REQUIRE_FALSE(c.get_columns_modified(1)->contains(96));
+
+        c.modifications_remove(1);
+        REQUIRE_FALSE(c.modifications_contains(1));
+        c.modifications_add(1, 99);
+        REQUIRE(columns(1) == (std::vector<int64_t>{99}));
+    }
+
+    SECTION("merge() combines modifications using different columns") {
+        c.modifications_add(1, 10);
+        c.modifications_add(2, 11);
+        ObjectChangeSet c2;
+        c2.modifications_add(2, 12);
+        c2.modifications_add(2, 10);
+        c2.modifications_add(3, 12);
+        c.merge(std::move(c2));
+        REQUIRE(columns(1) == (std::vector<int64_t>{10}));
+        REQUIRE(columns(2) == (std::vector<int64_t>{10, 11, 12}));
+        REQUIRE(columns(3) == (std::vector<int64_t>{12}));
+    }
+
+    SECTION("merge() drops inserted-then-deleted objects") {
+        c.insertions_add(1);
+        c.modifications_add(2, 10);
+        ObjectChangeSet c2;
+        c2.deletions_add(1);
+        c2.deletions_add(2);
+        c2.insertions_add(3);
+        c.merge(std::move(c2));
+        REQUIRE_FALSE(c.insertions_contains(1));
+        REQUIRE_FALSE(c.deletions_contains(1));
+        REQUIRE_FALSE(c.modifications_contains(2));
+        REQUIRE(c.deletions_contains(2));
+        REQUIRE(c.insertions_contains(3));
+    }
+
+    SECTION("merge() handles columns which overflow the mask") {
+        for (int64_t col = 0; col < 60; ++col)
+            c.modifications_add(1, col);
+        ObjectChangeSet c2;
+        for (int64_t col = 100; col > 50; --col)
+            c2.modifications_add(1, col);
+        c2.modifications_add(2, 100);
+        c.merge(std::move(c2));
+        auto cols = columns(1);
+        REQUIRE(cols.size() == 101);
+        for (int64_t col = 0; col <= 100; ++col)
+            REQUIRE(cols[col] == col);
+        REQUIRE(columns(2) == (std::vector<int64_t>{100}));
+    }
+
+    SECTION("allocates from the arena current when it was created") {
+        _impl::ChunkArena arena;
+        _impl::ChunkArena::Scope scope(arena);
+        ObjectChangeSet changes;
+        changes.insertions_add(1);
+        changes.modifications_add(2, 10);
+        size_t allocated = arena.bytes_allocated();
+        REQUIRE(allocated > 0);
+
+        {
+            // Copies made with no arena active use the heap, even if the
+            // source changeset is in an arena
+            _impl::ChunkArena::Scope heap_scope(nullptr);
+            ObjectChangeSet copy = changes;
+            copy.deletions_add(3);
+            REQUIRE(arena.bytes_allocated() == allocated);
+            REQUIRE(copy.insertions_contains(1));
+            REQUIRE(copy.modifications_contains(2));
+
+            // Growing a table keeps using the arena it was created in
+            for (int64_t key = 10; key < 1000; ++key)
+                changes.insertions_add(key);
+            REQUIRE(arena.bytes_allocated() > allocated);
+        }
+    }
+
+    SECTION("erase keeps the other keys reachable") {
+        std::mt19937_64 rng(0);
+        std::set<int64_t> expected;
+        for (int i = 0; i < 10'000; ++i) {
+            int64_t key = rng() % 2000;
+            if (rng() % 3 == 0) {
+                REQUIRE(c.insertions_remove(key) == (expected.erase(key) > 0));
+            }
+            else {
+                c.insertions_add(key);
+                expected.insert(key);
+            }
+        }
+        REQUIRE(c.insertions_size() == expected.size());
+        for (int64_t key = 0; key < 2000; ++key)
+            REQUIRE(c.insertions_contains(key) == (expected.count(key) > 0));
+        std::vector<int64_t> keys(c.get_insertions().begin(), c.get_insertions().end());
+        std::sort(keys.begin(), keys.end());
+        REQUIRE(keys == std::vector<int64_t>(expected.begin(), expected.end()));
+    }
+}
@@ -22,6 +22,8 @@
 
 #include "util/index_helpers.hpp"
 
+#include <memory>
+
 TEST_CASE("index_set: contains()") {
     SECTION("returns false if the index is before the first entry in the set") {
         realm::IndexSet set = {1, 2, 5};
@@ -89,6 +91,23 @@ TEST_CASE("index_set: count()") {
             REQUIRE(set.count(0, i) == (i + 1) / 3 + (i + 2) / 3);
         }
     }
+
+    SECTION("counts ranges which start partway through a chunk") {
+        size_t count = realm::_impl::ChunkedRangeVector::max_size * 4;
+        realm::IndexSet set;
+        for (size_t i = 0; i < count; ++i)
+            set.add(i * 2);
+
+        for (size_t i = 0; i < count * 2; i += 3) {
+            for (size_t j = i; j < count * 2; j += 5)
+                REQUIRE(set.count(i, j) == (j + 1) / 2 - (i + 1) / 2);
+        }
+    }
+
+    SECTION("returns zero when the end is before the start") {
+        realm::IndexSet set = {1, 2, 3};
+        REQUIRE(set.count(3, 1) == 0);
+    }
 }
 
 TEST_CASE("index_set: add()") {
@@ -149,6 +168,57 @@ TEST_CASE("index_set: add()") {
         set.add(set2);
         REQUIRE(set.count() == 30);
     }
+
+    SECTION("merges index sets whose ranges overlap") {
+        realm::IndexSet set2;
+        set.add(0, 5);
+        set.add(10, 15);
+        set2.add(3, 12);
+        set2.add(20, 22);
+        set.add(set2);
+        REQUIRE(set.count() == 17);
+        REQUIRE(std::distance(set.begin(), set.end()) == 2);
+        REQUIRE(set.contains(7));
+        REQUIRE(set.contains(21));
+    }
+
+    SECTION("merges large interleaved index sets") {
+        realm::IndexSet set2;
+        for (size_t i = 0; i < 300; i += 3) {
+            set.add(i);
+            set2.add(i + 1);
+        }
+        set.add(set2);
+        REQUIRE(set.count() == 200);
+        REQUIRE(std::distance(set.begin(), set.end()) == 100);
+    }
+
+    SECTION("adds a range after the end of the set") {
+        set = {0, 1};
+        set.add(3, 5);
+        REQUIRE_INDICES(set, 0, 1, 3, 4);
+    }
+
+    SECTION("extends the last range when adding a range adjacent to it") {
+        set = {0, 1};
+        set.add(2, 5);
+        REQUIRE_INDICES(set, 0, 1, 2, 3, 4);
+        REQUIRE(std::distance(set.begin(), set.end()) == 1);
+    }
+
+    SECTION("merges a range which overlaps existing ranges") {
+        set = {1, 5, 20};
+        set.add(3, 8);
+        REQUIRE_INDICES(set, 1, 3, 4, 5, 6, 7, 20);
+        set.add(0, 22);
+        REQUIRE(set.count() == 22);
+    }
+
+    SECTION("does nothing when adding an empty range") {
+        set = {1};
+        set.add(5, 5);
+        REQUIRE_INDICES(set, 1);
+    }
 }
 
 TEST_CASE("index_set: add_shifted()") {
@@ -246,6 +316,17 @@ TEST_CASE("index_set: add_shifted_by()") {
         set.add_shifted_by({2}, {2, 4});
         REQUIRE_INDICES(set, 3, 5);
     }
+
+    SECTION("keeps the counts of chunks made up of multi-index ranges correct") {
+        size_t count = realm::_impl::ChunkedRangeVector::max_size * 2;
+        for (size_t i = 0; i < count; ++i) {
+            set.add(i * 4);
+            set.add(i * 4 + 1);
+        }
+        set.add_shifted_by({}, {0});
+        REQUIRE(set.count() == count * 2 + 1);
+        REQUIRE(set.count(4) == count * 2 - 2);
+    }
 }
 
 TEST_CASE("index_set: set()") {
@@ -320,6 +401,18 @@ TEST_CASE("index_set: insert_at()") {
         set.insert_at({5, 10});
         REQUIRE_INDICES(set, 5, 6, 10, 12);
     }
+
+    SECTION("inserts ranges of positions inside existing ranges") {
+        realm::IndexSet positions;
+        set.add(0, 10);
+        positions.add(2, 4);
+        positions.add(20, 22);
+        set.insert_at(positions);
+        REQUIRE(set.count() == 14);
+        REQUIRE(std::distance(set.begin(), set.end()) == 2);
+        REQUIRE(set.contains(11));
+        REQUIRE_FALSE(set.contains(12));
+    }
 }
 
 TEST_CASE("index_set: shift_for_insert_at()") {
@@ -387,6 +480,14 @@ TEST_CASE("index_set: shift_for_insert_at()") {
         set.shift_for_insert_at({8, 10, 12});
         REQUIRE_INDICES(set, 5, 7, 9, 11);
     }
+
+    SECTION("shifts past ranges of insertion points") {
+        realm::IndexSet positions;
+        set.add(0, 6);
+        positions.add(2, 4);
+        set.shift_for_insert_at(positions);
+        REQUIRE_INDICES(set, 0, 1, 4, 5, 6, 7);
+    }
 }
 
 TEST_CASE("index_set: erase_at()") {
@@ -467,6 +568,16 @@ TEST_CASE("index_set: erase_at()") {
         set.erase_at({4, 6});
         REQUIRE_INDICES(set, 3, 4, 5);
     }
+
+    SECTION("erases ranges of positions which span several ranges") {
+        realm::IndexSet positions;
+        set.add(0, 5);
+        set.add(8, 12);
+        positions.add(3, 10);
+        set.erase_at(positions);
+        REQUIRE_INDICES(set, 0, 1, 2, 3, 4);
+        REQUIRE(std::distance(set.begin(), set.end()) == 1);
+    }
 }
 
 TEST_CASE("index_set: erase_or_unshift()") {
@@ -571,6 +682,17 @@ TEST_CASE("index_set: remove()") {
         set.remove({6, 11, 13});
         REQUIRE_INDICES(set, 5, 7, 10, 12, 15);
     }
+
+    SECTION("removes ranges which span several ranges") {
+        realm::IndexSet values;
+        set.add(0, 5);
+        set.add(8, 12);
+        set.add(20, 25);
+        values.add(3, 10);
+        values.add(22, 23);
+        set.remove(values);
+        REQUIRE_INDICES(set, 0, 1, 2, 10, 11, 20, 21, 23, 24);
+    }
 }
 
 TEST_CASE("index_set: shift()") {
@@ -584,6 +706,14 @@ TEST_CASE("index_set: shift()") {
         REQUIRE(set.shift(3) == 7);
         REQUIRE(set.shift(4) == 8);
     }
+
+    SECTION("skips over entire chunks") {
+        size_t count = realm::_impl::ChunkedRangeVector::max_size * 4;
+        for (size_t i = 0; i < count; ++i)
+            set.add(i * 3);
+        for (size_t i = 0; i < count * 2; ++i)
+            REQUIRE(set.shift(i) == i + i / 2 + 1);
+    }
 }
 
 TEST_CASE("index_set: unshift()") {
@@ -608,3 +738,69 @@ TEST_CASE("index_set: clear()") {
         REQUIRE(set.empty());
     }
 }
+
+TEST_CASE("index_set: arena allocation") {
+    realm::_impl::ChunkArena arena;
+
+    SECTION("allocates sets created inside a scope from the arena") {
+        realm::IndexSet set;
+        {
+            realm::_impl::ChunkArena::Scope scope(arena);
+            realm::IndexSet arena_set;
+            for (size_t i = 0; i < 100; i += 2)
+                arena_set.add(i);
+            set = std::move(arena_set);
+        }
+        REQUIRE(arena.bytes_allocated() > 0);
+        REQUIRE(set.count() == 50);
+    }
+
+    SECTION("allocates sets created outside of a scope from the heap") {
+        realm::IndexSet set = {1, 3, 5};
+        {
+            realm::_impl::ChunkArena::Scope scope(arena);
+            set.add(7);
+        }
+        REQUIRE(arena.bytes_allocated() == 0);
+    }
+
+    SECTION("restores the previous arena when a scope ends") {
+        realm::_impl::ChunkArena inner;
+        realm::_impl::ChunkArena::Scope scope(arena);
+        {
+            realm::_impl::ChunkArena::Scope inner_scope(inner);
+            REQUIRE(realm::_impl::ChunkArena::current() == &inner);
+        }
+        REQUIRE(realm::_impl::ChunkArena::current() == &arena);
+    }
+
+    SECTION("copies made outside of a scope do not use the arena") {
+        realm::IndexSet* arena_set;
+        std::unique_ptr<realm::IndexSet> holder;
+        {
+            realm::_impl::ChunkArena::Scope scope(arena);
+            holder = std::make_unique<realm::IndexSet>(realm::IndexSet{1, 3, 5});
+            arena_set = holder.get();
+        }
+        realm::IndexSet copy = *arena_set;
+        holder.reset();
+        arena.reset();
+        REQUIRE_INDICES(copy, 1, 3, 5);
+    }
+
+    SECTION("detach_from_arena() moves the set's storage to the heap") {
+        realm::IndexSet set;
+        {
+            realm::_impl::ChunkArena::Scope scope(arena);
+            realm::IndexSet arena_set;
+            for (size_t i = 0; i < 100; i += 2)
+                arena_set.add(i);
+            set = std::move(arena_set);
+        }
+        set.detach_from_arena();
+        arena.reset();
+        set.add(1);
+        REQUIRE(set.count() == 51);
+        REQUIRE(set.contains(98));
+    }
+}
@@ -24,6 +24,7 @@
 
 #include "feature_checks.hpp"
 #include "collection_notifications.hpp"
+#include "keypath_helpers.hpp"
 #include "object_accessor.hpp"
 #include "property.hpp"
 #include "schema.hpp"
@@ -288,12 +289,116 @@ TEST_CASE("object") {
             REQUIRE_INDICES(change.deletions, 0);
         }
 
+        SECTION("changes made before the first run are reported when notifiers were added at different versions") {
+            auto token = object.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+                change = c;
+            });
+
+            // Add a notifier for a different table at a later version, with
+            // no changes to the first table in between
+            auto other_table = r->read_group().get_table("class_array target");
+            r->begin_transaction();
+            auto other_obj = other_table->create_object();
+            r->commit_transaction();
+            Object other_object(r, other_obj);
+            auto other_token = other_object.add_notification_callback([](CollectionChangeSet, std::exception_ptr) {});
+
+            write([&] { obj.remove(); });
+            REQUIRE_INDICES(change.deletions, 0);
+        }
+
         SECTION("observing deleted object throws") {
             write([&] {
                 obj.remove();
             });
             REQUIRE_THROWS(require_change());
         }
+
+        SECTION("modifications to columns outside the key path filter are not reported") {
+            int calls = 0;
+            auto token = object.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+                change = c;
+                ++calls;
+            }, KeyPathArray{{{table->get_key(), col_keys[0]}}});
+            advance_and_notify(*r);
+            REQUIRE(calls == 1);
+
+            write([&] { obj.set(col_keys[1], 10); });
+            REQUIRE(calls == 1);
+
+            write([&] { obj.set(col_keys[0], 10); });
+            REQUIRE(calls == 2);
+            REQUIRE(change.columns.size() == 1);
+            REQUIRE_INDICES(change.columns[col_keys[0].value], 0);
+        }
+
+        SECTION("callbacks with different key path filters only see their own columns") {
+            CollectionChangeSet change0, change1;
+            auto token0 = object.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+                change0 = c;
+            }, KeyPathArray{{{table->get_key(), col_keys[0]}}});
+            auto token1 = object.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+                change1 = c;
+            }, KeyPathArray{{{table->get_key(), col_keys[1]}}});
+            advance_and_notify(*r);
+
+            write([&] {
+                obj.set(col_keys[0], 10);
+                obj.set(col_keys[1], 10);
+            });
+            REQUIRE(change0.columns.size() == 1);
+            REQUIRE_INDICES(change0.columns[col_keys[0].value], 0);
+            REQUIRE(change1.columns.size() == 1);
+            REQUIRE_INDICES(change1.columns[col_keys[1].value], 0);
+        }
+    }
+
+    SECTION("add_notification_callback() with a key path through a link") {
+        auto table = r->read_group().get_table("class_person");
+        auto col_age = table->get_column_key("age");
+        auto col_scores = table->get_column_key("scores");
+        auto col_assistant = table->get_column_key("assistant");
+
+        r->begin_transaction();
+        auto obj = table->create_object_with_primary_key(StringData("a"));
+        auto assistant = table->create_object_with_primary_key(StringData("b"));
+        obj.set(col_assistant, assistant.get_key());
+        r->commit_transaction();
+
+        Object object(r, obj);
+        CollectionChangeSet change;
+        int calls = 0;
+        auto key_paths = generate_key_path_array({"age", "assistant.age"}, *r, *r->schema().find("person"));
+        auto token = object.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+            change = c;
+            ++calls;
+        }, key_paths);
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        auto write = [&](auto&& f) {
+            r->begin_transaction();
+            f();
+            r->commit_transaction();
+            advance_and_notify(*r);
+        };
+
+        write([&] { assistant.get_list<int64_t>(col_scores).add(5); });
+        REQUIRE(calls == 1);
+
+        write([&] { assistant.set(col_age, 30); });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.modifications, 0);
+        REQUIRE(change.columns.size() == 1);
+        REQUIRE_INDICES(change.columns[col_assistant.value], 0);
+
+        write([&] { obj.set(col_age, 30); });
+        REQUIRE(calls == 3);
+        REQUIRE(change.columns.size() == 1);
+        REQUIRE_INDICES(change.columns[col_age.value], 0);
+
+        REQUIRE_THROWS(generate_key_path_array({"age.value"}, *r, *r->schema().find("person")));
+        REQUIRE_THROWS(generate_key_path_array({"assistant.missing"}, *r, *r->schema().find("person")));
     }
 
     TestContext d(r);
@@ -19,10 +19,12 @@
 #include "catch2/catch.hpp"
 
 #include "util/event_loop.hpp"
+#include "util/index_helpers.hpp"
 #include "util/test_file.hpp"
 #include "util/test_utils.hpp"
 
 #include "binding_context.hpp"
+#include "impl/notifier_executor.hpp"
 #include "impl/realm_coordinator.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
@@ -667,6 +669,186 @@ TEST_CASE("SharedRealm: notifications") {
     }
 }
 
+TEST_CASE("RealmCoordinator: shared notifier executor") {
+    if (!util::EventLoop::has_implementation())
+        return;
+
+    auto& executor = _impl::NotifierExecutor::shared();
+    REQUIRE(executor.thread_count() == 0);
+    executor.set_thread_count(2);
+    auto cleanup = util::make_scope_exit([&]() noexcept { executor.set_thread_count(0); });
+
+    Schema schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    struct File {
+        TestFile config;
+        SharedRealm realm;
+        Results results;
+        NotificationToken token;
+        size_t calls = 0;
+    };
+    std::vector<std::unique_ptr<File>> files;
+    for (int i = 0; i < 4; ++i) {
+        files.push_back(std::make_unique<File>());
+        auto& file = *files.back();
+        file.config.schema_version = 0;
+        file.config.schema = schema;
+        file.realm = Realm::get_shared_realm(file.config);
+        file.results = Results(file.realm, file.realm->read_group().get_table("class_object"));
+        file.token = file.results.add_notification_callback([&file](CollectionChangeSet, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            ++file.calls;
+        });
+    }
+
+    SECTION("initial notifications are delivered for every file") {
+        util::EventLoop::main().run_until([&] {
+            return std::all_of(files.begin(), files.end(), [](auto& file) { return file->calls > 0; });
+        });
+    }
+
+    SECTION("remote changes are delivered for every file") {
+        util::EventLoop::main().run_until([&] {
+            return std::all_of(files.begin(), files.end(), [](auto& file) { return file->calls > 0; });
+        });
+
+        for (auto& file : files) {
+            auto r2 = Realm::get_shared_realm(file->config);
+            r2->begin_transaction();
+            r2->read_group().get_table("class_object")->create_object();
+            r2->commit_transaction();
+        }
+        util::EventLoop::main().run_until([&] {
+            return std::all_of(files.begin(), files.end(), [](auto& file) { return file->calls > 1; });
+        });
+        for (auto& file : files)
+            REQUIRE(file->results.size() == 1);
+    }
+
+    SECTION("disabling the executor runs work on the calling thread") {
+        executor.set_thread_count(0);
+        util::EventLoop::main().run_until([&] {
+            return std::all_of(files.begin(), files.end(), [](auto& file) { return file->calls > 0; });
+        });
+    }
+}
+
+TEST_CASE("RealmCoordinator: notifier statistics") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+
+    auto stats = coordinator->get_notifier_statistics();
+    REQUIRE(stats.advance.count == 0);
+    REQUIRE(stats.run.count == 0);
+    REQUIRE(stats.new_notifiers == 0);
+
+    Results results(r, table->where());
+    Results sorted = results.sort({{"value", true}});
+    auto token = results.add_notification_callback([](CollectionChangeSet, std::exception_ptr) {});
+    auto sorted_token = sorted.add_notification_callback([](CollectionChangeSet, std::exception_ptr) {});
+
+    stats = coordinator->get_notifier_statistics();
+    REQUIRE(stats.new_notifiers == 2);
+    REQUIRE(stats.max_new_notifiers == 2);
+
+    advance_and_notify(*r);
+    stats = coordinator->get_notifier_statistics();
+    REQUIRE(stats.new_notifiers == 0);
+    REQUIRE(stats.max_new_notifiers == 2);
+    REQUIRE(stats.run.count == 2);
+    REQUIRE(stats.run_query.count == 2);
+    REQUIRE(stats.package_for_delivery.count == 2);
+    REQUIRE(stats.after_advance.count == 2);
+
+    r->begin_transaction();
+    table->create_object();
+    r->commit_transaction();
+    advance_and_notify(*r);
+
+    stats = coordinator->get_notifier_statistics();
+    REQUIRE(stats.advance.count > 0);
+    REQUIRE(stats.run.count > 2);
+    REQUIRE(stats.calculate_changes.count > 2);
+    REQUIRE(stats.package_for_delivery.count > 2);
+    REQUIRE(stats.after_advance.count > 2);
+
+    uint64_t total = 0;
+    for (auto count : stats.run.buckets)
+        total += count;
+    REQUIRE(total == stats.run.count);
+    REQUIRE(stats.run.max <= stats.run.total);
+}
+
+TEST_CASE("RealmCoordinator: change info cache") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    // Changes are only cached when more than one Transaction is expected to
+    // advance over each commit
+    bool shared = false;
+    SECTION("single notifier group") { }
+    SECTION("multiple notifier groups") {
+        config.notifier_thread_count = 2;
+        shared = true;
+    }
+
+    auto r = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+    auto col = table->get_column_key("value");
+
+    Results results(r, table->where());
+    CollectionChangeSet changes;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+        changes = std::move(c);
+    });
+    advance_and_notify(*r);
+
+    auto stats = coordinator->get_notifier_statistics();
+    REQUIRE(stats.change_info_cache_hits == 0);
+    REQUIRE(stats.change_info_cache_misses == 0);
+
+    // The new notifier is added at the same version as the existing one is
+    // at, so the advancer and the notifier Transaction both advance over the
+    // same commit and with caching only the first of them needs to parse it
+    Results results2(r, table->where().greater(col, 0));
+    int calls2 = 0;
+    auto token2 = results2.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+        ++calls2;
+    });
+
+    auto r2 = coordinator->get_realm(util::Scheduler::get_frozen());
+    r2->begin_transaction();
+    r2->read_group().get_table("class_object")->create_object().set(col, 1);
+    r2->commit_transaction();
+    advance_and_notify(*r);
+
+    stats = coordinator->get_notifier_statistics();
+    REQUIRE(stats.change_info_cache_misses == (shared ? 1 : 0));
+    REQUIRE(stats.change_info_cache_hits == (shared ? 1 : 0));
+    REQUIRE_INDICES(changes.insertions, 0);
+    REQUIRE(calls2 == 1);
+    REQUIRE(results2.size() == 1);
+}
+
 TEST_CASE("SharedRealm: schema updating from external changes") {
     TestFile config;
     config.schema_version = 0;
@@ -25,6 +25,7 @@
 #include "impl/object_accessor_impl.hpp"
 #include "impl/realm_coordinator.hpp"
 #include "binding_context.hpp"
+#include "keypath_helpers.hpp"
 #include "object_schema.hpp"
 #include "property.hpp"
 #include "results.hpp"
@@ -412,6 +413,53 @@ TEST_CASE("notifications: async delivery") {
         REQUIRE(called);
     }
 
+    SECTION("notifications are not delivered when a callback is removed on another thread during delivery") {
+        NotificationToken token2, token3;
+        token2 = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            JoiningThread([&] { token3 = {}; });
+        });
+        token3 = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            REQUIRE(false);
+        });
+
+        advance_and_notify(*r);
+    }
+
+    SECTION("removing a callback after it has been delivered to destroys it immediately") {
+        auto captured = std::make_shared<int>(0);
+        std::weak_ptr<int> weak_captured = captured;
+        NotificationToken token2 = results.add_notification_callback([captured](CollectionChangeSet, std::exception_ptr) {
+            ++*captured;
+        });
+        captured.reset();
+        advance_and_notify(*r);
+        REQUIRE(*weak_captured.lock() == 1);
+
+        token2 = {};
+        REQUIRE(weak_captured.expired());
+    }
+
+    SECTION("suppressing the next notification works while callbacks are removed on another thread") {
+        NotificationToken token2;
+        int calls2 = 0;
+        token2 = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            ++calls2;
+        });
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+        REQUIRE(calls2 == 1);
+
+        r->begin_transaction();
+        table->begin()->set(col, 4);
+        token.suppress_next();
+        JoiningThread([&] { token2 = {}; });
+        r->commit_transaction();
+
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+        REQUIRE(calls2 == 1);
+    }
+
     SECTION("the first call of a notification can include changes if it previously ran for a different callback") {
         r->begin_transaction();
         auto token2 = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
@@ -975,6 +1023,758 @@ TEST_CASE("notifications: skip") {
     }
 }
 
+TEST_CASE("notifications: parallel notifiers") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.notifier_thread_count = 3;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+    auto col = table->get_column_key("value");
+
+    r->begin_transaction();
+    for (int i = 0; i < 10; ++i)
+        table->create_object().set(col, i);
+    r->commit_transaction();
+
+    struct Observer {
+        Results results;
+        NotificationToken token;
+        int calls = 0;
+        CollectionChangeSet changes;
+    };
+    std::vector<std::unique_ptr<Observer>> observers;
+    auto add_observer = [&](int min_value) {
+        observers.push_back(std::make_unique<Observer>());
+        auto& observer = *observers.back();
+        observer.results = Results(r, table->where().greater_equal(col, min_value));
+        observer.token = observer.results.add_notification_callback([&observer](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            ++observer.calls;
+            observer.changes = std::move(c);
+        });
+    };
+    for (int i = 0; i < 6; ++i)
+        add_observer(i);
+
+    auto make_remote_change = [&] {
+        auto r2 = coordinator->get_realm(util::Scheduler::get_frozen());
+        r2->begin_transaction();
+        auto table2 = r2->read_group().get_table("class_object");
+        table2->get_object(9).remove();
+        table2->create_object().set(col, 5);
+        r2->commit_transaction();
+    };
+
+    advance_and_notify(*r);
+    for (auto& observer : observers)
+        REQUIRE(observer->calls == 1);
+
+    SECTION("every notifier produces correct changes") {
+        make_remote_change();
+        advance_and_notify(*r);
+        for (int i = 0; i < 6; ++i) {
+            auto& observer = *observers[i];
+            REQUIRE(observer.calls == 2);
+            REQUIRE_INDICES(observer.changes.deletions, 9 - i);
+            REQUIRE_INDICES(observer.changes.insertions, 9 - i);
+            REQUIRE(observer.results.size() == size_t(10 - i));
+        }
+    }
+
+    SECTION("notifiers added later are run with the existing ones") {
+        for (int i = 0; i < 5; ++i)
+            add_observer(i);
+        advance_and_notify(*r);
+        for (size_t i = 0; i < observers.size(); ++i)
+            REQUIRE(observers[i]->calls == 1);
+
+        make_remote_change();
+        advance_and_notify(*r);
+        for (auto& observer : observers)
+            REQUIRE(observer->calls == 2);
+    }
+
+    SECTION("skipped notifications are only skipped for the suppressed callback") {
+        r->begin_transaction();
+        table->create_object().set(col, 20);
+        observers[3]->token.suppress_next();
+        r->commit_transaction();
+        make_remote_change();
+
+        advance_and_notify(*r);
+        for (int i = 0; i < 6; ++i) {
+            auto& observer = *observers[i];
+            REQUIRE(observer.calls == 2);
+            if (i == 3)
+                REQUIRE_INDICES(observer.changes.insertions, 10 - i);
+            else
+                REQUIRE_INDICES(observer.changes.insertions, 9 - i, 10 - i);
+        }
+    }
+
+    SECTION("removing all of the notifiers in a group") {
+        for (int i = 1; i < 5; ++i)
+            observers[i] = nullptr;
+        advance_and_notify(*r);
+
+        make_remote_change();
+        add_observer(0);
+        advance_and_notify(*r);
+        REQUIRE(observers[0]->calls == 2);
+        REQUIRE(observers[5]->calls == 2);
+        REQUIRE(observers[6]->calls == 1);
+        REQUIRE(observers[6]->results.size() == 10);
+    }
+
+    SECTION("reopening the file with a different thread count") {
+        observers.clear();
+        r->close();
+        r = nullptr;
+
+        config.notifier_thread_count = 5;
+        r = Realm::get_shared_realm(config);
+        table = r->read_group().get_table("class_object");
+        for (int i = 0; i < 8; ++i)
+            add_observer(i);
+        advance_and_notify(*r);
+
+        r->begin_transaction();
+        table->create_object().set(col, 20);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        for (auto& observer : observers) {
+            REQUIRE(observer->calls == 2);
+            REQUIRE(observer->changes.insertions.count() == 1);
+        }
+    }
+
+    SECTION("a lone notifier for a large collection") {
+        observers.clear();
+        r->begin_transaction();
+        for (int i = 0; i < 150'000; ++i)
+            table->create_object().set(col, 100);
+        r->commit_transaction();
+        advance_and_notify(*r);
+
+        // Only the main group has a notifier, so the pool is lent to it
+        add_observer(0);
+        advance_and_notify(*r);
+        REQUIRE(observers[0]->calls == 1);
+
+        r->begin_transaction();
+        table->get_object(3).remove();
+        table->get_object(15).set(col, 101);
+        table->get_object(100'000).set(col, 101);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(observers[0]->calls == 2);
+        REQUIRE_INDICES(observers[0]->changes.deletions, 3);
+        REQUIRE_INDICES(observers[0]->changes.modifications, 16, 100'001);
+        REQUIRE(observers[0]->results.size() == 150'009);
+    }
+}
+
+TEST_CASE("notifications: shared notifiers") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+        {"other object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+    auto other_table = r->read_group().get_table("class_other object");
+    auto col = table->get_column_key("value");
+
+    r->begin_transaction();
+    for (int i = 0; i < 10; ++i) {
+        table->create_object().set(col, i);
+        other_table->create_object().set(other_table->get_column_key("value"), i);
+    }
+    r->commit_transaction();
+
+    auto add_callback = [](Results& results, int& calls, CollectionChangeSet& changes) {
+        return results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            ++calls;
+            changes = std::move(c);
+        });
+    };
+
+    Results results1(r, table->where().greater(col, 2));
+    Results results2(r, table->where().greater(col, 2));
+    int calls1 = 0, calls2 = 0;
+    CollectionChangeSet changes1, changes2;
+    auto token1 = add_callback(results1, calls1, changes1);
+    auto token2 = add_callback(results2, calls2, changes2);
+
+    advance_and_notify(*r);
+    REQUIRE(calls1 == 1);
+    REQUIRE(calls2 == 1);
+
+    auto modify = [&] {
+        r->begin_transaction();
+        table->get_object(0).set(col, 5);
+        table->get_object(5).remove();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("both callbacks get the same changes") {
+        modify();
+        REQUIRE(calls1 == 2);
+        REQUIRE(calls2 == 2);
+        REQUIRE_INDICES(changes1.insertions, 0);
+        REQUIRE_INDICES(changes1.deletions, 2);
+        REQUIRE_INDICES(changes2.insertions, 0);
+        REQUIRE_INDICES(changes2.deletions, 2);
+        REQUIRE(results1.size() == 7);
+        REQUIRE(results2.size() == 7);
+        REQUIRE(results1.get(0).get_key() == results2.get(0).get_key());
+    }
+
+    SECTION("destroying one of the Results does not stop notifications for the other") {
+        token1 = {};
+        results1 = {};
+        modify();
+        REQUIRE(calls1 == 1);
+        REQUIRE(calls2 == 2);
+        REQUIRE_INDICES(changes2.insertions, 0);
+        REQUIRE_INDICES(changes2.deletions, 2);
+        REQUIRE(results2.size() == 7);
+    }
+
+    SECTION("destroying one of the Results stops the callbacks added through it") {
+        results1 = {};
+        modify();
+        REQUIRE(calls1 == 1);
+        REQUIRE(calls2 == 2);
+        REQUIRE_INDICES(changes2.deletions, 2);
+
+        // The token outliving its callback is fine
+        token1 = {};
+        modify();
+        REQUIRE(calls1 == 1);
+        REQUIRE(calls2 == 3);
+    }
+
+    SECTION("destroying the Results which shared the notifier stops its callbacks") {
+        results2 = {};
+        modify();
+        REQUIRE(calls1 == 2);
+        REQUIRE(calls2 == 1);
+        REQUIRE_INDICES(changes1.deletions, 2);
+    }
+
+    SECTION("suppressing notifications only applies to the suppressed callback") {
+        r->begin_transaction();
+        table->get_object(0).set(col, 5);
+        token1.suppress_next();
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls1 == 1);
+        REQUIRE(calls2 == 2);
+        REQUIRE_INDICES(changes2.insertions, 0);
+    }
+
+    SECTION("a new Results with the same query gets an initial notification") {
+        Results results3(r, table->where().greater(col, 2));
+        int calls3 = 0;
+        CollectionChangeSet changes3;
+        auto token3 = add_callback(results3, calls3, changes3);
+        advance_and_notify(*r);
+        REQUIRE(calls1 == 1);
+        REQUIRE(calls3 == 1);
+        REQUIRE(results3.size() == 7);
+
+        modify();
+        REQUIRE(calls1 == 2);
+        REQUIRE(calls3 == 2);
+        REQUIRE_INDICES(changes3.insertions, 0);
+        REQUIRE_INDICES(changes3.deletions, 2);
+    }
+
+    SECTION("Results with a different query, ordering or table are not affected") {
+        auto sorted = Results(r, table->where().greater(col, 2)).sort({{"value", false}});
+        Results other(r, other_table->where().greater(other_table->get_column_key("value"), 2));
+        Results different(r, table->where().greater(col, 3));
+
+        int sorted_calls = 0, other_calls = 0, different_calls = 0;
+        CollectionChangeSet sorted_changes, other_changes, different_changes;
+        auto token3 = add_callback(sorted, sorted_calls, sorted_changes);
+        auto token4 = add_callback(other, other_calls, other_changes);
+        auto token5 = add_callback(different, different_calls, different_changes);
+        advance_and_notify(*r);
+
+        modify();
+        REQUIRE(sorted_calls == 2);
+        REQUIRE_INDICES(sorted_changes.insertions, 4);
+        REQUIRE_INDICES(sorted_changes.deletions, 4);
+        REQUIRE(other_calls == 1);
+        REQUIRE(different_calls == 2);
+        REQUIRE_INDICES(different_changes.deletions, 1);
+        REQUIRE(different.size() == 6);
+    }
+}
+
+TEST_CASE("notifications: incremental updates") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+            {"other", PropertyType::Int},
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+    auto col = table->get_column_key("value");
+    auto other_col = table->get_column_key("other");
+
+    r->begin_transaction();
+    for (int i = 0; i < 100; ++i)
+        table->create_object(ObjKey(i)).set(col, i);
+    r->commit_transaction();
+
+    Results results(r, table->where().greater(col, 10).less(col, 90));
+    int calls = 0;
+    CollectionChangeSet change;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = std::move(c);
+        ++calls;
+    });
+    advance_and_notify(*r);
+    REQUIRE(calls == 1);
+    REQUIRE(results.size() == 79);
+
+    auto write = [&](auto&& fn) {
+        r->begin_transaction();
+        fn();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("inserting a matching object reports an insertion") {
+        write([&] {
+            table->create_object(ObjKey(150)).set(col, 50);
+            table->create_object(ObjKey(151)).set(col, 5);
+        });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.insertions, 79);
+        REQUIRE(change.deletions.empty());
+        REQUIRE(results.size() == 80);
+        REQUIRE(results.get(79).get_key() == ObjKey(150));
+    }
+
+    SECTION("deleting a matching object reports a deletion") {
+        write([&] {
+            table->remove_object(ObjKey(20));
+            table->remove_object(ObjKey(95));
+        });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.deletions, 9);
+        REQUIRE(change.insertions.empty());
+        REQUIRE(results.size() == 78);
+    }
+
+    SECTION("modifying an object so that it starts or stops matching reports an insertion or deletion") {
+        write([&] {
+            table->get_object(ObjKey(5)).set(col, 50);
+            table->get_object(ObjKey(30)).set(col, 0);
+        });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.insertions, 0);
+        REQUIRE_INDICES(change.deletions, 19);
+        REQUIRE(change.modifications.empty());
+        REQUIRE(results.size() == 79);
+        REQUIRE(results.get(0).get_key() == ObjKey(5));
+    }
+
+    SECTION("modifying a matching object reports a modification") {
+        write([&] {
+            table->get_object(ObjKey(20)).set(other_col, 1);
+            table->get_object(ObjKey(40)).set(col, 41);
+            table->get_object(ObjKey(95)).set(other_col, 1);
+        });
+        REQUIRE(calls == 2);
+        REQUIRE(change.insertions.empty());
+        REQUIRE(change.deletions.empty());
+        REQUIRE_INDICES(change.modifications, 9, 29);
+        REQUIRE_INDICES(change.modifications_new, 9, 29);
+    }
+
+    SECTION("modifying a non-matching object does not send a notification") {
+        write([&] {
+            table->get_object(ObjKey(5)).set(other_col, 1);
+        });
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("changes over multiple commits are combined") {
+        r->begin_transaction();
+        table->create_object(ObjKey(150)).set(col, 50);
+        r->commit_transaction();
+        r->begin_transaction();
+        table->get_object(ObjKey(150)).set(col, 0);
+        table->get_object(ObjKey(11)).set(other_col, 1);
+        r->commit_transaction();
+        r->begin_transaction();
+        table->remove_object(ObjKey(12));
+        r->commit_transaction();
+        advance_and_notify(*r);
+
+        REQUIRE(calls == 2);
+        REQUIRE(change.insertions.empty());
+        REQUIRE_INDICES(change.deletions, 1);
+        REQUIRE_INDICES(change.modifications, 0);
+        REQUIRE(results.size() == 78);
+    }
+
+    SECTION("changing most of the objects produces the same result as rerunning the query") {
+        write([&] {
+            for (int i = 0; i < 100; i += 2)
+                table->get_object(ObjKey(i)).set(col, 100 - i);
+        });
+        REQUIRE(calls == 2);
+        auto expected = table->where().greater(col, 10).less(col, 90).count();
+        REQUIRE(results.size() == expected);
+        REQUIRE(change.insertions.count() + 79 - change.deletions.count() == expected);
+    }
+
+    SECTION("sorted results are unaffected") {
+        auto sorted = results.sort({{"value", false}});
+        int sorted_calls = 0;
+        CollectionChangeSet sorted_change;
+        auto sorted_token = sorted.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            sorted_change = std::move(c);
+            ++sorted_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(sorted_calls == 1);
+
+        write([&] {
+            table->get_object(ObjKey(30)).set(col, 0);
+        });
+        REQUIRE(sorted_calls == 2);
+        REQUIRE_INDICES(sorted_change.deletions, 59);
+        REQUIRE(sorted.size() == 78);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.deletions, 19);
+    }
+}
+
+TEST_CASE("notifications: min delivery interval") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+    auto col = table->get_column_key("value");
+
+    r->begin_transaction();
+    for (int i = 0; i < 10; ++i)
+        table->create_object(ObjKey(i)).set(col, i);
+    r->commit_transaction();
+
+    // Long enough that the writes which are expected to be held back always
+    // finish well within it; only the steps which check delivery after the
+    // interval actually wait for it
+    const auto interval = std::chrono::seconds(1);
+
+    Results results(r, table->where());
+    int calls = 0, unlimited_calls = 0;
+    CollectionChangeSet change;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = std::move(c);
+        ++calls;
+    }, interval);
+    auto unlimited_token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        ++unlimited_calls;
+    });
+
+    advance_and_notify(*r);
+    REQUIRE(calls == 1);
+    REQUIRE(unlimited_calls == 1);
+
+    auto write = [&](auto&& fn) {
+        r->begin_transaction();
+        fn();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("initial notification and first change are delivered immediately") {
+        write([&] { table->get_object(ObjKey(0)).set(col, 10); });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.modifications, 0);
+    }
+
+    SECTION("changes within the interval are merged and delivered after it") {
+        write([&] { table->get_object(ObjKey(0)).set(col, 10); });
+        REQUIRE(calls == 2);
+
+        write([&] { table->get_object(ObjKey(1)).set(col, 10); });
+        write([&] { table->remove_object(ObjKey(2)); });
+        write([&] { table->create_object(ObjKey(20)); });
+        REQUIRE(calls == 2);
+        REQUIRE(unlimited_calls == 5);
+
+        std::this_thread::sleep_for(interval);
+        advance_and_notify(*r);
+        REQUIRE(calls == 3);
+        REQUIRE(unlimited_calls == 5);
+        REQUIRE_INDICES(change.modifications, 1);
+        REQUIRE_INDICES(change.deletions, 2);
+        REQUIRE_INDICES(change.insertions, 9);
+    }
+
+    SECTION("no notification is sent after the interval if nothing changed") {
+        write([&] { table->get_object(ObjKey(0)).set(col, 10); });
+        std::this_thread::sleep_for(interval);
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+    }
+
+    SECTION("removing the callback while changes are held back discards them") {
+        write([&] { table->get_object(ObjKey(0)).set(col, 10); });
+        write([&] { table->get_object(ObjKey(1)).set(col, 10); });
+        token = {};
+        std::this_thread::sleep_for(interval);
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+    }
+
+    SECTION("skipping a notification while changes are held back merges it into them") {
+        write([&] { table->get_object(ObjKey(0)).set(col, 10); });
+        write([&] { table->remove_object(ObjKey(2)); });
+        REQUIRE(calls == 2);
+
+        r->begin_transaction();
+        table->remove_object(ObjKey(5));
+        token.suppress_next();
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+        REQUIRE(unlimited_calls == 4);
+
+        std::this_thread::sleep_for(interval);
+        advance_and_notify(*r);
+        REQUIRE(calls == 3);
+        REQUIRE_INDICES(change.deletions, 2, 5);
+        REQUIRE(results.size() == 8);
+    }
+}
+
+TEST_CASE("notifications: key path filtering") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"person", {
+            {"name", PropertyType::Int},
+            {"age", PropertyType::Int},
+            {"avatar", PropertyType::Object|PropertyType::Nullable, "image"},
+        }},
+        {"image", {
+            {"url", PropertyType::Int},
+            {"size", PropertyType::Int},
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto people = r->read_group().get_table("class_person");
+    auto images = r->read_group().get_table("class_image");
+    auto col_name = people->get_column_key("name");
+    auto col_age = people->get_column_key("age");
+    auto col_avatar = people->get_column_key("avatar");
+    auto col_url = images->get_column_key("url");
+    auto col_size = images->get_column_key("size");
+
+    r->begin_transaction();
+    for (int i = 0; i < 10; ++i) {
+        auto image = images->create_object(ObjKey(i));
+        people->create_object(ObjKey(i)).set(col_name, i).set(col_avatar, image.get_key());
+    }
+    r->commit_transaction();
+
+    auto key_paths = generate_key_path_array({"name", "avatar.url"}, *r, *r->schema().find("person"));
+    REQUIRE(key_paths == (KeyPathArray{{{people->get_key(), col_name}},
+                                       {{people->get_key(), col_avatar}, {images->get_key(), col_url}}}));
+
+    Results results(r, people->where());
+    int calls = 0;
+    CollectionChangeSet change;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = std::move(c);
+        ++calls;
+    }, key_paths);
+    advance_and_notify(*r);
+    REQUIRE(calls == 1);
+
+    auto write = [&](auto&& fn) {
+        r->begin_transaction();
+        fn();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+    // Whether every per-column modification is for one of the given columns
+    auto columns_within = [](CollectionChangeSet const& c, std::vector<ColKey> const& cols) {
+        return std::all_of(c.columns.begin(), c.columns.end(), [&](auto& column) {
+            return std::any_of(cols.begin(), cols.end(), [&](ColKey col) { return col.value == column.first; });
+        });
+    };
+
+    SECTION("modifying a property in the filter reports a modification") {
+        write([&] {
+            people->get_object(ObjKey(1)).set(col_name, 10);
+            people->get_object(ObjKey(2)).set(col_age, 10);
+        });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.modifications, 1);
+        REQUIRE(columns_within(change, {col_name, col_avatar}));
+    }
+
+    SECTION("modifying a property of a linked object in the filter reports a modification") {
+        write([&] { images->get_object(ObjKey(2)).set(col_url, 10); });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.modifications, 2);
+    }
+
+    SECTION("modifying properties outside the filter does not send a notification") {
+        write([&] { people->get_object(ObjKey(1)).set(col_age, 10); });
+        write([&] { images->get_object(ObjKey(2)).set(col_size, 10); });
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("insertions and deletions are reported regardless of the filter") {
+        write([&] { people->create_object(ObjKey(20)); });
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.insertions, 10);
+
+        write([&] { people->remove_object(ObjKey(0)); });
+        REQUIRE(calls == 3);
+        REQUIRE_INDICES(change.deletions, 0);
+    }
+
+    SECTION("a callback without a filter does not change what a filtered callback sees") {
+        int unfiltered_calls = 0;
+        CollectionChangeSet unfiltered_change;
+        auto unfiltered_token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+            unfiltered_change = std::move(c);
+            ++unfiltered_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(unfiltered_calls == 1);
+
+        write([&] { images->get_object(ObjKey(2)).set(col_size, 10); });
+        REQUIRE(unfiltered_calls == 2);
+        REQUIRE_INDICES(unfiltered_change.modifications, 2);
+        REQUIRE(calls == 1);
+
+        write([&] {
+            images->get_object(ObjKey(3)).set(col_size, 10);
+            images->get_object(ObjKey(4)).set(col_url, 10);
+        });
+        REQUIRE(unfiltered_calls == 3);
+        REQUIRE_INDICES(unfiltered_change.modifications, 3, 4);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.modifications, 4);
+    }
+
+    SECTION("callbacks with different filters each see only their own modifications") {
+        int age_calls = 0;
+        CollectionChangeSet age_change;
+        auto age_token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr) {
+            age_change = std::move(c);
+            ++age_calls;
+        }, generate_key_path_array({"age"}, *r, *r->schema().find("person")));
+        advance_and_notify(*r);
+        REQUIRE(age_calls == 1);
+
+        write([&] { people->get_object(ObjKey(1)).set(col_age, 10); });
+        REQUIRE(age_calls == 2);
+        REQUIRE_INDICES(age_change.modifications, 1);
+        REQUIRE(columns_within(age_change, {col_age}));
+        REQUIRE(calls == 1);
+
+        write([&] { people->get_object(ObjKey(2)).set(col_name, 10); });
+        REQUIRE(age_calls == 2);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(change.modifications, 2);
+        REQUIRE(columns_within(change, {col_name, col_avatar}));
+
+        write([&] {
+            people->get_object(ObjKey(3)).set(col_name, 10);
+            people->get_object(ObjKey(3)).set(col_age, 10);
+        });
+        REQUIRE(age_calls == 3);
+        REQUIRE(calls == 3);
+        REQUIRE(columns_within(age_change, {col_age}));
+        REQUIRE(columns_within(change, {col_name, col_avatar}));
+    }
+
+    SECTION("a filtered callback on a shared notifier is not affected by the other Results") {
+        Results results2(r, people->where());
+        int unfiltered_calls = 0;
+        auto unfiltered_token = results2.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            ++unfiltered_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(unfiltered_calls == 1);
+
+        write([&] { people->get_object(ObjKey(1)).set(col_age, 10); });
+        REQUIRE(unfiltered_calls == 2);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("invalid key paths are rejected") {
+        REQUIRE_THROWS(generate_key_path_array({"name.url"}, *r, *r->schema().find("person")));
+        REQUIRE_THROWS(generate_key_path_array({"avatar.missing"}, *r, *r->schema().find("person")));
+        REQUIRE_THROWS(generate_key_path_array({""}, *r, *r->schema().find("person")));
+    }
+}
+
 TEST_CASE("notifications: TableView delivery") {
     _impl::RealmCoordinator::assert_no_open_realms();
 
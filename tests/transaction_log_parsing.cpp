@@ -1463,6 +1463,22 @@ TEST_CASE("Transaction log parsing: changeset calcuation") {
             REQUIRE(changes.array_change(0, tr_col) == (ArrayChange{Kind::None, {}}));
         }
 
+        SECTION("deleting a row discards the changes to all of its arrays but not other rows' arrays") {
+            auto o2 = origin->get_object(origin_keys[1]);
+            auto changes = observe({o, o2}, [&] {
+                lv.add(target_keys[0]);
+                tr.add(0);
+                lv2.add(target_keys[0]);
+                tr2.add(0);
+                o.remove();
+            });
+            REQUIRE(changes.invalidated(0));
+            REQUIRE(changes.array_change(0, lv_col) == (ArrayChange{Kind::None, {}}));
+            REQUIRE(changes.array_change(0, tr_col) == (ArrayChange{Kind::None, {}}));
+            REQUIRE(changes.array_change(1, lv_col) == (ArrayChange{Kind::Insert, {1}}));
+            REQUIRE(changes.array_change(1, tr_col) == (ArrayChange{Kind::Insert, {10}}));
+        }
+
         SECTION("int array: rollback clear()") {
             auto changes = observe_rollback({o}, [&] {
                 tr.clear();
@@ -1683,6 +1699,56 @@ TEST_CASE("DeepChangeChecker") {
         CHECK_FALSE(checker3(15));
         CHECK(checker3(18));
         CHECK(checker3(19));
+
+        using Strategy = _impl::DeepChangeChecker::Strategy;
+        SECTION("the depth limit is configurable") {
+            for (auto strategy : {Strategy::Forward, Strategy::Backlinks}) {
+                _impl::DeepChangeChecker shallow(info, *table, tables, 0, 2, strategy);
+                CHECK(shallow(19));
+                CHECK(shallow(18));
+                CHECK_FALSE(shallow(17));
+
+                _impl::DeepChangeChecker deep(info, *table, tables, 0, 8, strategy);
+                CHECK(deep(12));
+                CHECK_FALSE(deep(11));
+            }
+        }
+
+        SECTION("walking backlinks gives the same results") {
+            _impl::DeepChangeChecker backlinks(info, *table, tables, 0, 4, Strategy::Backlinks);
+            REQUIRE(backlinks.uses_backlinks());
+            CHECK_FALSE(backlinks(15));
+            CHECK(backlinks(16));
+            CHECK(backlinks(18));
+            CHECK(backlinks(19));
+            CHECK_FALSE(backlinks(0));
+        }
+
+        SECTION("backlinks are used automatically when there are few modifications") {
+            CHECK_FALSE(_impl::DeepChangeChecker(info, *table, tables).uses_backlinks());
+            CHECK_FALSE(_impl::DeepChangeChecker(info, *table, tables, 2).uses_backlinks());
+            CHECK(_impl::DeepChangeChecker(info, *table, tables, 20).uses_backlinks());
+        }
+    }
+
+    SECTION("changes over linklists are tracked by walking backlinks") {
+        r->begin_transaction();
+        for (int i = 0; i < 3; ++i) {
+            objects[i].get_linklist(cols[3]).add(objects[i].get_key());
+            objects[i].get_linklist(cols[3]).add(objects[i + 1 + (i == 2)].get_key());
+        }
+        r->commit_transaction();
+
+        auto info = track_changes([&] {
+            objects[4].set(cols[0], 10);
+        });
+
+        _impl::DeepChangeChecker checker(info, *table, tables, 0, 4, _impl::DeepChangeChecker::Strategy::Backlinks);
+        REQUIRE(checker(0));
+        REQUIRE(checker(1));
+        REQUIRE(checker(2));
+        REQUIRE_FALSE(checker(3));
+        REQUIRE(checker(4));
     }
 
     SECTION("changes made in the 3rd elements in the link list") {